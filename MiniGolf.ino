@@ -1,7 +1,12 @@
+// #define RENDER_CHECK // print checksums of a fixed set of rendered frames over Serial on boot (see src/RenderCheck.h)
+// #define MEMORY_CHECK // print class sizes and the stack/heap high-water marks over Serial (see src/MemoryCheck.h)
+
 #include "src/FX/ArduboyFX.h"
 #include "src/FX/fxdata.h"
 #include "src/Game.h"
 #include "src/CreditsSprite.h"
+#include "src/MemoryCheck.h"
+#include "src/RenderCheck.h"
 #include <Arduboy2.h>
 
 Arduboy2Base arduboy;
@@ -11,15 +16,25 @@ unsigned long previousTime = 0;
 void setup()
 {
     arduboy.begin();
-    arduboy.setFrameRate(60);
+    arduboy.setFrameRate(FullFrameRate);
 
-    FX::begin(FX_DATA_PAGE);
+    FX::begin(FX_DATA_PAGE, FX_SAVE_PAGE);
+    Materials::Load();
 
     previousTime = millis();
 
     game.Init();
 
+#ifdef RENDER_CHECK
+    RenderCheck::Run(arduboy);
+#endif
+
     PlayCreditsAnimation(arduboy);
+    arduboy.clear();
+
+#ifdef MEMORY_CHECK
+    MemoryCheck::Begin();
+#endif
 }
 
 void loop()
@@ -27,7 +42,7 @@ void loop()
     while (!arduboy.nextFrame())
         return;
 
-    arduboy.clear();
+    // screen buffer is cleared (or pre-filled with the next background) by game.PresentFrame()
     arduboy.pollButtons();
 
     unsigned long currentTime = millis();
@@ -36,7 +51,15 @@ void loop()
     float secondsDelta = timeDelta * (1.0f / 1000.0f);
 
     game.Tick(secondsDelta);
-    game.Display();
 
-    FX::display();
+    // identical frames are skipped, the display keeps showing the last one
+    if (game.NeedsRedraw())
+    {
+        game.Display();
+        game.PresentFrame();
+    }
+
+#ifdef MEMORY_CHECK
+    MemoryCheck::Tick();
+#endif
 }
@@ -0,0 +1,250 @@
+# Renders the zoomed-out overview of every map in fxdata.txt into PNG sprite sheets, one
+# frame per map in Maps order, for the overview of the map explorer (Camera::DrawOverview)
+# and the minimap shown while aiming (Camera::DrawMinimap).
+# Run from this directory before building the FX data whenever a map changes:
+#
+#   python3 generate_overviews.py
+#
+# Maps are rasterized at full size (walls, circles, polygons, terrain and the area swept by
+# the movers), then downsampled to 1/2 and 1/4 scale. An output pixel is lit if any pixel it
+# covers is, so one pixel wide walls survive the downsampling. Terrain shows as a checkerboard.
+#
+# The minimap thumbnail stretches every map to THUMBNAIL_WIDTH x THUMBNAIL_HEIGHT, map pixel
+# (x, y) landing on (x * THUMBNAIL_WIDTH // width, y * THUMBNAIL_HEIGHT // height) as in
+# Camera::DrawMinimap. It only shows the obstacles, terrain would fill it at that scale.
+
+import re
+import struct
+import zlib
+
+MAP_BYTES = 289         # sizeof(Map) on the Arduboy
+CHUNK_BYTES = 37        # sizeof(MapChunk)
+CHUNK_SIZE = 128        # ChunkCache::ChunkSize
+TERRAIN_CELL = 8        # Terrain::CellSize
+TERRAIN_COLUMNS = 32    # Terrain::GridColumns
+MAX_MAP_WIDTH = 384     # frames are sized for the largest map
+MAX_MAP_HEIGHT = 256
+SCALES = (('MapOverviewHalf', 2), ('MapOverviewQuarter', 4))
+THUMBNAIL_WIDTH = 32    # Camera::MinimapWidth
+THUMBNAIL_HEIGHT = 16   # Camera::MinimapHeight
+
+BLACK, WHITE = 0, 1
+
+
+def load_array(text, name):
+    body = text[text.index('uint8_t %s = {' % name):]
+    body = body[body.index('{') + 1:]
+    depth = 1
+    for i, c in enumerate(body):
+        depth += {'{': 1, '}': -1}.get(c, 0)
+        if depth == 0:
+            body = body[:i]
+            break
+    body = re.sub(r'//[^\n]*', '', body).replace('{', ' ').replace('}', ' ')
+    values = []
+    for token in re.split(r',', body):
+        token = token.strip()
+        if not token:
+            continue
+        if token.startswith('"'):
+            values += list(token.strip('"').encode()) + [0]
+        else:
+            values.append(int(token, 0) & 0xFF)
+    return values
+
+
+def u16(data, offset):
+    return data[offset] | data[offset + 1] << 8
+
+
+def s8(value):
+    return value - 256 if value > 127 else value
+
+
+class Map:
+    def __init__(self, data, chunks):
+        self.width = u16(data, 1)
+        self.height = u16(data, 3)
+        first_chunk = u16(data, 26)
+        columns, rows = data[28], data[29]
+        offset = 30
+        self.walls = [data[offset + i * 5:offset + i * 5 + 4] for i in range(21)]
+        offset += 21 * 5
+        self.circles = [data[offset + i * 4:offset + i * 4 + 3] for i in range(14)]
+        offset += 14 * 4
+        self.polygons = [data[offset + i * 29:offset + i * 29 + 14] for i in range(2)]
+        offset += 2 * 29
+        self.movers = [data[offset + i * 10:offset + i * 10 + 7] for i in range(4)]
+
+        # a chunked map has its walls and circles in ObstacleChunks, relative to each chunk
+        for index in range(columns * rows):
+            chunk = chunks[(first_chunk + index) * CHUNK_BYTES:(first_chunk + index + 1) * CHUNK_BYTES]
+            x0, y0 = index % columns * CHUNK_SIZE, index // columns * CHUNK_SIZE
+            for i in range(5):
+                x1, y1, x2, y2 = chunk[i * 5:i * 5 + 4]
+                if x1 or y1 or x2 or y2:
+                    self.walls.append([x1 + x0, y1 + y0, x2 + x0, y2 + y0])
+            for i in range(3):
+                x, y, radius = chunk[25 + i * 4:25 + i * 4 + 3]
+                self.circles.append([x + x0, y + y0, radius])
+
+
+class Canvas:
+    def __init__(self, width, height):
+        self.width = width
+        self.height = height
+        self.pixels = [[BLACK] * width for _ in range(height)]
+
+    def set(self, x, y, color=WHITE):
+        if 0 <= x < self.width and 0 <= y < self.height:
+            self.pixels[y][x] = color
+
+    def line(self, x1, y1, x2, y2):
+        dx, dy = abs(x2 - x1), -abs(y2 - y1)
+        sx, sy = (1 if x1 < x2 else -1), (1 if y1 < y2 else -1)
+        error = dx + dy
+        while True:
+            self.set(x1, y1)
+            if x1 == x2 and y1 == y2:
+                return
+            doubled = 2 * error
+            if doubled >= dy:
+                error += dy
+                x1 += sx
+            if doubled <= dx:
+                error += dx
+                y1 += sy
+
+    # matches the outline of Arduboy2Base::drawCircle
+    def circle(self, x0, y0, r):
+        f, dx, dy, x, y = 1 - r, 1, -2 * r, 0, r
+        for px, py in ((0, r), (0, -r), (r, 0), (-r, 0)):
+            self.set(x0 + px, y0 + py)
+        while x < y:
+            if f >= 0:
+                y -= 1
+                dy += 2
+                f += dy
+            x += 1
+            dx += 2
+            f += dx
+            for px, py in ((x, y), (-x, y), (x, -y), (-x, -y), (y, x), (-y, x), (y, -x), (-y, -x)):
+                self.set(x0 + px, y0 + py)
+
+    def dotted_rect(self, x, y, width, height):
+        for i in range(0, width + 1, 2):
+            self.set(x + i, y)
+            self.set(x + i, y + height)
+        for j in range(0, height + 1, 2):
+            self.set(x, y + j)
+            self.set(x + width, y + j)
+
+    def downsample(self, scale, width, height):
+        out = Canvas(width, height)
+        for y in range(min(height, self.height // scale)):
+            for x in range(min(width, self.width // scale)):
+                if any(self.pixels[y * scale + j][x * scale + i] for j in range(scale) for i in range(scale)):
+                    out.set(x, y)
+        return out
+
+    def stretch(self, width, height):
+        out = Canvas(width, height)
+        for y in range(self.height):
+            for x in range(self.width):
+                if self.pixels[y][x]:
+                    out.set(x * width // self.width, y * height // self.height)
+        return out
+
+
+def render(game_map):
+    canvas = Canvas(game_map.width, game_map.height)
+
+    for x1, y1, x2, y2 in game_map.walls:
+        if x1 or y1 or x2 or y2:
+            canvas.line(x1, y1, x2, y2)
+
+    for x, y, radius in game_map.circles:
+        if radius:
+            canvas.circle(x, y, radius)
+
+    for polygon in game_map.polygons:
+        count = polygon[0]
+        vertices = [(polygon[2 + i * 2], polygon[3 + i * 2]) for i in range(count)]
+        for i in range(count):
+            canvas.line(*vertices[i], *vertices[(i + 1) % count])
+
+    # movers at rest: the area they sweep (see Movers::GetBounds)
+    for kind, ax, ay, bx, by, travel_x, travel_y in game_map.movers:
+        if kind == 0:
+            continue
+        travel_x, travel_y = s8(travel_x), s8(travel_y)
+        if kind == 1:
+            left, top, right, bottom = ax - bx, ay - bx, ax + bx, ay + bx
+        elif kind == 2:
+            left, top, right, bottom = min(ax, bx), min(ay, by), max(ax, bx), max(ay, by)
+        else:
+            left, top, right, bottom = ax, ay, ax + bx, ay + by
+        if kind != 1:
+            left, top = left + min(travel_x, 0), top + min(travel_y, 0)
+            right, bottom = right + max(travel_x, 0), bottom + max(travel_y, 0)
+        canvas.dotted_rect(left, top, right - left, bottom - top)
+
+    return canvas
+
+
+def overlay_terrain(canvas, terrain, scale):
+    cell = TERRAIN_CELL // scale
+    for row in range(TERRAIN_COLUMNS):
+        for column in range(TERRAIN_COLUMNS):
+            pair = terrain[row * TERRAIN_COLUMNS // 2 + column // 2]
+            if (pair >> 4 if column % 2 == 0 else pair & 0x0F) == 0:
+                continue
+            for j in range(cell):
+                for i in range(cell):
+                    x, y = column * cell + i, row * cell + j
+                    if (x + y) % 2 == 0:
+                        canvas.set(x, y)
+
+
+def write_png(path, rows):
+    raw = b''.join(b'\x00' + b''.join(b'\xff\xff\xff\xff' if p else b'\x00\x00\x00\xff' for p in row) for row in rows)
+    header = struct.pack('>IIBBBBB', len(rows[0]), len(rows), 8, 6, 0, 0, 0)
+
+    def chunk(kind, data):
+        return struct.pack('>I', len(data)) + kind + data + struct.pack('>I', zlib.crc32(kind + data) & 0xffffffff)
+
+    with open(path, 'wb') as f:
+        f.write(b'\x89PNG\r\n\x1a\n' + chunk(b'IHDR', header) + chunk(b'IDAT', zlib.compress(raw, 9)) + chunk(b'IEND', b''))
+
+
+def write_sheet(name, frames, width, height):
+    rows = [sum((f.pixels[y] for f in frames), []) for y in range(height)]
+    write_png('%s_%dx%d.png' % (name, width, height), rows)
+    print('%s: %d frames of %dx%d' % (name, len(frames), width, height))
+
+
+if __name__ == '__main__':
+    text = open('../FX/fxdata.txt').read()
+    maps = load_array(text, 'Maps')
+    chunks = load_array(text, 'ObstacleChunks')
+    terrains = load_array(text, 'TerrainGrids')
+    grid_bytes = TERRAIN_COLUMNS * TERRAIN_COLUMNS // 2
+
+    renders = []
+    for index in range(len(maps) // MAP_BYTES):
+        game_map = Map(maps[index * MAP_BYTES:(index + 1) * MAP_BYTES], chunks)
+        terrain = terrains[index * grid_bytes:(index + 1) * grid_bytes]
+        renders.append((render(game_map), terrain))
+
+    for name, scale in SCALES:
+        width, height = MAX_MAP_WIDTH // scale, MAX_MAP_HEIGHT // scale
+        frames = []
+        for canvas, terrain in renders:
+            frame = canvas.downsample(scale, width, height)
+            overlay_terrain(frame, terrain, scale)
+            frames.append(frame)
+
+        write_sheet(name, frames, width, height)
+
+    thumbnails = [canvas.stretch(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT) for canvas, _ in renders]
+    write_sheet('MapThumbnail', thumbnails, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT)
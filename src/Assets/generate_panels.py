@@ -0,0 +1,184 @@
+# Renders the pre-baked UI panels (dotted border, black background and static text)
+# into PNG sprite sheets for fxdata.txt. Run from this directory before building the
+# FX data whenever the panel layouts in Camera.h/UIPanels.h or the font change:
+#
+#   python3 generate_panels.py
+#
+# Each panel has two frames, one per phase of the flickering dotted border.
+# Pixels outside a panel are transparent, so the panels are drawn masked.
+
+import re
+import struct
+import zlib
+
+FONT_WIDTH = 4
+FONT_HEIGHT = 7
+LINE_HEIGHT = 8
+SCREEN_WIDTH = 128
+SCREEN_HEIGHT = 64
+HALF_SCREEN_WIDTH = SCREEN_WIDTH // 2
+MAX_MAP_NAME_LENGTH = 15
+
+TRANSPARENT, BLACK, WHITE = None, 0, 1
+
+
+def load_glyphs():
+    text = open('../FX/fxdata.txt').read()
+    body = text[text.index('uint8_t Font4x6Glyphs'):]
+    body = body[body.index('{') + 1:body.index('}')]
+    body = re.sub(r'//[^\n]*', '', body)
+    values = [int(v, 0) for v in re.split(r'[,\s]+', body) if v]
+    return {chr(32 + i): values[i * 4:i * 4 + 4] for i in range(len(values) // 4)}
+
+
+GLYPHS = load_glyphs()
+
+
+class Canvas:
+    def __init__(self, width=SCREEN_WIDTH, height=SCREEN_HEIGHT):
+        self.width = width
+        self.height = height
+        self.pixels = [[TRANSPARENT] * width for _ in range(height)]
+
+    def set(self, x, y, color):
+        if 0 <= x < self.width and 0 <= y < self.height:
+            self.pixels[y][x] = color
+
+    def fill_rect(self, x, y, width, height, color):
+        for j in range(height):
+            for i in range(width):
+                self.set(x + i, y + j, color)
+
+    # matches Camera::DrawDottedBorder
+    def dotted_border(self, x, y, width, height, phase):
+        self.fill_rect(x, y, width, height, BLACK)
+        for i in range(width):
+            if (i % 2 == 0) == phase:
+                self.set(x + i, y, WHITE)
+            j = height - 1
+            if ((i % 2 == 1) ^ (j % 2 == 0)) == phase:
+                self.set(x + i, y + j, WHITE)
+        for j in range(height):
+            if (j % 2 == 0) == phase:
+                self.set(x, y + j, WHITE)
+            i = width - 1
+            if ((i % 2 == 1) ^ (j % 2 == 0)) == phase:
+                self.set(x + i, y + j, WHITE)
+
+    # matches Font4x6::printLine (glyphs are drawn one pixel below the cursor)
+    def text(self, x, y, string):
+        for c in string:
+            for i, column in enumerate(GLYPHS.get(c, [0] * FONT_WIDTH)):
+                for bit in range(8):
+                    if column & (1 << bit):
+                        self.set(x + i, y + 1 + bit, WHITE)
+            x += FONT_WIDTH + 1
+
+    def bounds(self):
+        xs = [x for row in self.pixels for x, p in enumerate(row) if p is not None]
+        ys = [y for y, row in enumerate(self.pixels) for p in row if p is not None]
+        return min(xs), min(ys), max(xs) + 1, max(ys) + 1
+
+
+def text_width(string):
+    return len(string) * (FONT_WIDTH + 1) - 1
+
+
+# Box drawn by Camera::PrintCenteredWithBackground for a block of lines
+def centered_box(num_lines, longest_line, top):
+    width = longest_line * (FONT_WIDTH + 1) - 1 + 4
+    height = num_lines * FONT_HEIGHT + (num_lines - 1) + 2
+    x = HALF_SCREEN_WIDTH - width // 2
+    return x - 2, top - 2, width + 4, height + 4
+
+
+# A centered panel: lines is a list of (label, slot, suffix) tuples. The label and
+# suffix are baked, the slot placeholder only reserves room for the runtime value so
+# the line is centered as it would be with a typical value. Returns the slot positions.
+def centered_panel(canvas, lines, top, phase, longest=None):
+    widest = longest or max(len(''.join(line)) for line in lines)
+    canvas.dotted_border(*centered_box(len(lines), widest, top), phase)
+    slots = []
+    y = top
+    for label, slot, suffix in lines:
+        x = HALF_SCREEN_WIDTH - text_width(label + slot + suffix) // 2
+        canvas.text(x, y, label)
+        canvas.text(x + len(label + slot) * (FONT_WIDTH + 1), y, suffix)
+        if slot:
+            slots.append((x + len(label) * (FONT_WIDTH + 1), y))
+        y += LINE_HEIGHT
+    return slots
+
+
+def map_summary(canvas, phase):
+    # only the box, sized for the longest name; the lines are drawn at runtime
+    centered_panel(canvas, [('', '', '')] * 3, 20, phase, MAX_MAP_NAME_LENGTH + 2)
+    return []
+
+
+def map_complete(canvas, phase):
+    return centered_panel(canvas, [('Hole ', '1', ' Complete!'), ('par:     ', '1', ''), ('strokes: ', '1', ''),
+                                   ('', '', ''), ('game total: ', '+1', ''), ('Press A to continue', '', '')], 8, phase)
+
+
+def map_complete_no_total(canvas, phase):
+    return centered_panel(canvas, [('Hole ', '1', ' Complete!'), ('par:     ', '1', ''), ('strokes: ', '1', ''),
+                                   ('Press A to continue', '', '')], 10, phase)
+
+
+def game_summary(canvas, phase):
+    return centered_panel(canvas, [('All Holes Complete!', '', ''), ('', '', ''), ('Final Score', '', ''),
+                                   ('Par:     ', '11', ''), ('Strokes: ', '11', ''), ('Total:   ', '+1', '')], 7, phase)
+
+
+# Full screen, matches the layout of Camera::DrawPauseMenu
+def pause_menu(canvas, phase):
+    canvas.fill_rect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, BLACK)
+    canvas.dotted_border(0, 0, text_width('Paused') + 4, FONT_HEIGHT + 3, phase)
+    canvas.text(2, 1, 'Paused')
+    canvas.text(64, 0, '   Hole ')
+    canvas.text(64, 8, 'par:      ')
+    canvas.text(64, 16, 'strokes:  ')
+    canvas.text(0, 48, ' Resume')
+    canvas.text(0, 56, ' Exit to main menu')
+    return [(64 + 8 * (FONT_WIDTH + 1), 0), (64 + 10 * (FONT_WIDTH + 1), 8), (64 + 10 * (FONT_WIDTH + 1), 16)]
+
+
+def write_png(path, rows):
+    raw = b''
+    for row in rows:
+        raw += b'\x00' + b''.join(
+            b'\x00\x00\x00\x00' if p is None else (b'\xff\xff\xff\xff' if p else b'\x00\x00\x00\xff') for p in row)
+    header = struct.pack('>IIBBBBB', len(rows[0]), len(rows), 8, 6, 0, 0, 0)
+
+    def chunk(kind, data):
+        return struct.pack('>I', len(data)) + kind + data + struct.pack('>I', zlib.crc32(kind + data) & 0xffffffff)
+
+    with open(path, 'wb') as f:
+        f.write(b'\x89PNG\r\n\x1a\n' + chunk(b'IHDR', header) + chunk(b'IDAT', zlib.compress(raw, 9)) + chunk(b'IEND', b''))
+
+
+def build(name, render):
+    frames = []
+    slots = None
+    for phase in (False, True):
+        canvas = Canvas()
+        slots = render(canvas, phase)
+        frames.append(canvas)
+
+    x0, y0, x1, y1 = frames[0].bounds()
+    width, height = x1 - x0, y1 - y0
+    rows = [sum((f.pixels[y][x0:x1] for f in frames), []) for y in range(y0, y1)]
+    write_png('%s_%dx%d.png' % (name, width, height), rows)
+
+    print('%s: x=%d y=%d width=%d height=%d' % (name, x0, y0, width, height))
+    for x, y in slots:
+        print('    slot x=%d y=%d' % (x, y))
+
+
+if __name__ == '__main__':
+    build('MapSummaryPanel', map_summary)
+    build('MapCompletePanel', map_complete)
+    build('MapCompleteNoTotalPanel', map_complete_no_total)
+    build('GameSummaryPanel', game_summary)
+    build('PauseMenuPanel', pause_menu)
@@ -4,11 +4,15 @@
 
 class Ball
 {
+public:
+    static constexpr float PhysicsStep = 1.0f / 120; // seconds simulated by each call to Move()
+
 private:
-    static constexpr float _friction = .60;           // percentage to reduce velocity by every second
+    static constexpr float _friction = .60;           // velocity decays as e^(-friction * seconds)
     static constexpr uint8_t _powerChangePerSecond = 100;
     static constexpr float _aimChangePerSecond = 1.75;
     static constexpr float _minVelocityThreshold = 4;
+    static constexpr float _minVelocityThresholdSquared = _minVelocityThreshold * _minVelocityThreshold;
     static constexpr float _minVelocitySecondsThreshold = 1; // stop the ball when velocity < threshold for this many seconds
 
     bool _powerIncreasing = true;
@@ -25,6 +29,11 @@ public:
     static constexpr uint8_t MaxPower = 150;
     static constexpr uint8_t DefaultPower = (MaxPower + MinPower) / 2;
 
+    // Exact integration of the friction over one PhysicsStep:
+    // velocity is multiplied by GroundDecay, and the distance travelled is velocity * GroundDisplacement
+    static constexpr float GroundDecay = exp(-_friction * PhysicsStep);
+    static constexpr float GroundDisplacement = (1 - GroundDecay) / _friction;
+
     Ball() = default;
     Ball(float x, float y) : X(x), Y(y) {}
 
@@ -70,30 +79,50 @@ public:
 
     void StartHit()
     {
-        Velocity.x = cos(Direction) * Power;
-        Velocity.y = -sin(Direction) * Power;
+        Launch({cos(Direction) * Power, -sin(Direction) * Power});
+    }
+
+    // Sets the ball in motion, e.g. when it is struck by the club or by another ball
+    void Launch(const Vector &velocity)
+    {
+        Velocity = velocity;
         _minVelocitySeconds = 0;
     }
 
-    void Move(float secondsDelta)
+    // Advances the ball by one PhysicsStep on open ground
+    void Move()
     {
-        X += Velocity.x * secondsDelta;
-        Y += Velocity.y * secondsDelta;
+        X += Velocity.x * GroundDisplacement;
+        Y += Velocity.y * GroundDisplacement;
 
-        ApplyFriction(secondsDelta);
+        ApplyFriction(GroundDecay, PhysicsStep);
     }
 
-    void ApplyFriction(float secondsDelta)
+    // Multiplies the velocity by a precomputed decay factor. slowSeconds is added to the
+    // stop timer if the ball ends up below the minimum velocity.
+    void ApplyFriction(float decay, float slowSeconds)
     {
-        Velocity.x -= Velocity.x * _friction * secondsDelta;
-        Velocity.y -= Velocity.y * _friction * secondsDelta;
+        Velocity = Velocity * decay;
 
-        if (Velocity.Length() < _minVelocityThreshold)
-            _minVelocitySeconds += secondsDelta;
+        if (Velocity.LengthSquared() < _minVelocityThresholdSquared)
+            _minVelocitySeconds += slowSeconds;
         else
             _minVelocitySeconds = 0;
     }
 
+    // Decay factor for a surface that applies `multiplier` times the normal friction
+    static constexpr float FrictionDecay(float multiplier)
+    {
+        return exp(-_friction * multiplier * PhysicsStep);
+    }
+
+    // Where the ball comes to rest on open ground, relative to where it is. The friction
+    // decays the velocity exponentially, so the ball still rolls velocity / friction.
+    Vector GetRollOffset() const
+    {
+        return Velocity * (1 / _friction);
+    }
+
     bool IsStopped()
     {
         return _minVelocitySeconds >= _minVelocitySecondsThreshold;
@@ -4,19 +4,38 @@
 #include "Constants.h"
 #include "FX/ArduboyFX.h"
 #include "FX/fxdata.h"
+#include "ForceField.h"
 #include "Font4x6/Font4x6.h"
 #include "Map.h"
 #include "MapManager.h"
+#include "Material.h"
+#include "Movers.h"
+#include "Terrain.h"
+#include "UIPanels.h"
+#include "UIText.h"
 #include <Arduboy2.h>
 
+// Endless mode goes on past 9 holes, see Camera::GetHoleSlotNumber()
+static_assert(MapManager::MaxCourseHoles <= 9, "UI panel hole number slots only fit a single digit");
+
+// Groups of animated elements, used to select which animations affect a screen
+namespace AnimationLayer
+{
+    constexpr uint8_t Map = 1 << 0;        // treadmills and hole
+    constexpr uint8_t MenuFlag = 1 << 1;   // waving flag on the menu background
+    constexpr uint8_t Border = 1 << 2;     // flickering dotted borders
+    constexpr uint8_t TextFlash = 1 << 3;  // flashing indicator text ("View Map", "2x") and minimap markers
+    constexpr uint8_t PageArrows = 1 << 4; // flashing page arrows on the instructions
+}
+
 class Camera
 {
 private:
-    Arduboy2Base _arduboy;
+    Arduboy2Base &_arduboy;
     int16_t _cameraX;
     int16_t _cameraY;
-    uint8_t _mapWidth;
-    uint8_t _mapHeight;
+    uint16_t _mapWidth;
+    uint16_t _mapHeight;
     uint8_t _treadmillFrame = 0;
     uint8_t _startScreenFlagWaveFrame = 0;
     int8_t _startScreenFlagWaveFrameIncreasing = 1; // used to increment/decrement sprite frame (ex: 0,1,2,3,2,1,0...)
@@ -24,6 +43,12 @@ private:
     bool _borderFlickerToggle = false; // alternate true/false to make the DottedBorder dynamic
     Font4x6 _font4x6;
     bool _textFlashToggle = false;
+    bool _pageArrowFlashToggle = false;
+    uint16_t _animationTick = 0; // counts in full-frame-rate frames, regardless of the actual frame rate
+    uint8_t _panFrames = 0;      // frames the map explorer has been scrolling in the same direction
+    uint8_t _minimapY = MinimapTopY; // corner picked by PlaceMinimap()
+    int8_t _panX = 0;            // that direction, as passed to Pan()
+    int8_t _panY = 0;
 
     static constexpr uint8_t FontWidth = 4;
     static constexpr uint8_t FontHeight = 7;
@@ -32,26 +57,49 @@ private:
     static constexpr uint8_t MaxPowerLineLength = 40;
     static constexpr uint8_t MinPowerLineLength = 10;
     static constexpr uint8_t MaxBoundaryPadding = 5;
+    static constexpr uint8_t MaxLeadX = 32;     // how far ahead of the ball Follow() looks
+    static constexpr uint8_t MaxLeadY = 16;
+    static constexpr uint8_t EaseShift = 2;     // Follow() covers a quarter of the distance to its target per frame
+    static constexpr uint8_t MaxScrollStep = 8; // pixels Follow() scrolls per frame, bounding the redraw
+    static constexpr uint8_t PageHeight = 8;    // rows of pixels in a byte of the screen buffer
+    static constexpr uint8_t BallMargin = 8;    // Follow() always keeps the ball this far inside the screen
+    static constexpr uint8_t MinPanSpeed = 2;
+    static constexpr uint8_t MaxPanSpeed = 8; // MinPanSpeed times a power of 2
+    static constexpr uint8_t PanRampFrames = 12; // the map explorer doubles its speed every PanRampFrames
     static constexpr int8_t HoleNoFlagXOffset = -3;
     static constexpr int8_t HoleNoFlagYOffset = -3;
     static constexpr int8_t HoleWithFlagXOffset = -4;
     static constexpr int8_t HoleWithFlagYOffset = -11;
+    static constexpr uint16_t ScreenBufferSize = WIDTH * HEIGHT / 8;
+    static constexpr int8_t MaxForceArrowLength = ForceField::CellSize / 2 - 1;
+    static constexpr uint8_t ScorecardWidth = 72;
+    static constexpr uint8_t ScorecardX = (WIDTH - ScorecardWidth) / 2;
+    static constexpr uint8_t ScorecardY = 12;
+    static constexpr uint8_t FXImageHeaderSize = 4; // width and height (uint16_t each) precede FX image frames
+    static constexpr uint8_t MinimapX = WIDTH - MapThumbnailWidth; // right edge, in either corner page aligned
+    static constexpr uint8_t MinimapTopY = 0;
+    static constexpr uint8_t MinimapBottomY = HEIGHT - MapThumbnailHeight;
+
+    // The screen buffer is shared by every Camera, so the prefetch state is too
+    static uint24_t _nextBackground;       // full-screen FX bitmap to stream in while the current frame is sent to the OLED
+    static uint24_t _prefetchedBackground; // full-screen FX bitmap already sitting in the screen buffer (0 = none)
+    static bool _holdFrame;                // keep the screen buffer when the current frame is presented
+    static bool _frameHeld;                // the screen buffer still holds the last presented frame
 
-    const char *StartMenuTextOptions[StartScreenNumOptions] = {
-        "Play All Holes",
-        "Select Hole",
-        "Instructions"};
+public:
+    Camera(Arduboy2Base &arduboy) : _arduboy(arduboy)
+    {
+        Reset(0, 0, WIDTH, HEIGHT);
+    }
 
-    const char *PauseMenuTextOptions[StartScreenNumOptions] = {
-        "Resume",
-        "Exit to main menu"};
+    // Cameras are reset in place for every map, never copied
+    Camera(const Camera &) = delete;
+    Camera &operator=(const Camera &) = delete;
 
-public:
-    Camera() = default;
-    Camera(Arduboy2Base arduboy, uint8_t x, uint8_t y, uint8_t mapWidth, uint8_t mapHeight)
-        : _arduboy(arduboy), _mapWidth(mapWidth), _mapHeight(mapHeight)
+    void Reset(int16_t x, int16_t y, uint16_t mapWidth, uint16_t mapHeight)
     {
-        _font4x6 = Font4x6();
+        _mapWidth = mapWidth;
+        _mapHeight = mapHeight;
         FocusOn(x, y);
     }
 
@@ -63,117 +111,177 @@ public:
         KeepInBounds();
     }
 
-    void DrawMap(const Map &map)
+    // Eases toward the ball, leading it toward where it will come to rest. Call once per
+    // tick, `frames` being the number of full-frame-rate frames since the last call.
+    //
+    // The camera moves a fraction of the way to its target each frame, at most MaxScrollStep
+    // pixels, so a shot scrolls smoothly and redraws a bounded amount per frame. The target
+    // is on a whole byte of the screen buffer vertically, and the camera scrolls vertically
+    // in whole bytes while it is at least that far from it, so the terrain cells and the
+    // sprites on the 8 pixel grid are drawn page aligned, without shifting.
+    void Follow(const Ball &ball, uint8_t frames)
     {
-        // draw floor texture (dots on ground)
-        uint8_t dotSpacing = 16;
-        for (int i = dotSpacing / 2; i < _mapWidth; i += dotSpacing)
+        Vector lead = ball.GetRollOffset();
+        int16_t targetX = ball.X + constrain(lead.x, -MaxLeadX, MaxLeadX) - HalfScreenWidth;
+        int16_t targetY = ball.Y + constrain(lead.y, -MaxLeadY, MaxLeadY) - HalfScreenHeight;
+        targetY = (targetY + PageHeight / 2) & ~(PageHeight - 1);
+
+        for (uint8_t i = 0; i < frames; i++)
         {
-            for (int j = dotSpacing / 2; j < _mapHeight; j += dotSpacing)
-            {
-                _arduboy.drawPixel(i - _cameraX, j - _cameraY);
-            }
+            _cameraX = Ease(_cameraX, targetX, 1);
+            _cameraY = Ease(_cameraY, targetY, PageHeight);
         }
 
-        // draw treadmills
-        for (auto tread : map.treadmills)
-        {
-            if (tread.IsEmpty())
-                continue;
+        // a fast or fast-forwarded ball can outrun the easing
+        _cameraX = constrain(_cameraX, static_cast<int16_t>(ball.X) - WIDTH + BallMargin, static_cast<int16_t>(ball.X) - BallMargin);
+        _cameraY = constrain(_cameraY, static_cast<int16_t>(ball.Y) - HEIGHT + BallMargin, static_cast<int16_t>(ball.Y) - BallMargin);
 
-            uint24_t sprite = 0;
-            switch (tread.direction)
-            {
-                case Direction::Up:
-                    sprite = TreadmillUpSprite;
-                    break;
-                case Direction::Down:
-                    sprite = TreadmillDownSprite;
-                    break;
-                case Direction::Left:
-                    sprite = TreadmillLeftSprite;
-                    break;
-                case Direction::Right:
-                    sprite = TreadmillRightSprite;
-                    break;
-            }
+        KeepInBounds();
+    }
 
-            for (uint8_t x = 0; x < tread.width; x += TreadmillUpSpriteWidth)
+    // withMinimap: DrawMinimap() will cover its corner, so what is entirely under
+    // it (floor dots, terrain cells, circles and walls) is skipped
+    void DrawMap(const Map &map, uint16_t moverTick = 0, bool withMinimap = false)
+    {
+        // draw floor texture (dots on ground), only the ones on screen
+        uint8_t dotSpacing = 16;
+        int16_t right = min(_cameraX + WIDTH, static_cast<int16_t>(_mapWidth));
+        int16_t bottom = min(_cameraY + HEIGHT, static_cast<int16_t>(_mapHeight));
+        for (int16_t i = max(_cameraX, 0) / dotSpacing * dotSpacing + dotSpacing / 2; i < right; i += dotSpacing)
+        {
+            for (int16_t j = max(_cameraY, 0) / dotSpacing * dotSpacing + dotSpacing / 2; j < bottom; j += dotSpacing)
             {
-                int16_t drawX = x + tread.x - _cameraX;
-                if (drawX < -(int8_t)TreadmillUpSpriteWidth || drawX > WIDTH)
+                if (withMinimap && IsUnderMinimap(i - _cameraX, j - _cameraY, 1, 1))
                     continue;
 
-                for (uint8_t y = 0; y < tread.height; y += TreadmillUpSpriteHeight)
-                {
-                    int16_t drawY = y + tread.y - _cameraY;
-                    if (drawY < -(int8_t)TreadmillUpSpriteHeight || drawY > HEIGHT)
-                        continue;
-
-                    FX::drawBitmap(drawX, drawY, sprite, _treadmillFrame, dbmNormal);
-                }
+                _arduboy.drawPixel(i - _cameraX, j - _cameraY);
             }
         }
 
+        DrawTerrain(map, withMinimap);
+
+        // obstacles are relative to the map's origin (see ChunkCache.h)
+        int16_t viewX = _cameraX - map.originX;
+        int16_t viewY = _cameraY - map.originY;
+
         // draw circles
         for (auto circle : map.circles)
         {
             if (circle.IsEmpty())
                 continue;
 
-            int16_t drawX = circle.location.x - _cameraX;
-            int16_t drawY = circle.location.y - _cameraY;
+            int16_t drawX = circle.location.x - viewX;
+            int16_t drawY = circle.location.y - viewY;
 
             if (drawX + circle.radius < 0 || drawX - circle.radius > WIDTH ||
                 drawY + circle.radius < 0 || drawY - circle.radius > HEIGHT)
                 continue;
+            if (withMinimap && IsUnderMinimap(drawX - circle.radius, drawY - circle.radius, 2 * circle.radius + 1, 2 * circle.radius + 1))
+                continue;
 
             _arduboy.fillCircle(drawX, drawY, circle.radius, BLACK);
             _arduboy.drawCircle(drawX, drawY, circle.radius, WHITE);
         }
 
-        // draw sand traps
-        uint8_t gridWidth = 5;
-        for (auto sandtrap : map.sandTraps)
+        // draw walls
+        for (auto wall : map.walls)
         {
-            if (sandtrap.IsEmpty())
+            if (wall.IsEmpty())
+                continue;
+            // a wall between two points under the minimap is entirely under it
+            if (withMinimap && IsUnderMinimap(wall.p1.x - viewX, wall.p1.y - viewY, 1, 1) &&
+                IsUnderMinimap(wall.p2.x - viewX, wall.p2.y - viewY, 1, 1))
                 continue;
 
-            for (uint8_t x = 0; x < sandtrap.width; x += SandtrapSpriteWidth)
-            {
-                int16_t drawX = x + sandtrap.x - _cameraX;
-                if (drawX < -(int8_t)SandtrapSpriteWidth || drawX > WIDTH)
-                    continue;
+            _arduboy.drawLine(wall.p1.x - viewX,
+                              wall.p1.y - viewY,
+                              wall.p2.x - viewX,
+                              wall.p2.y - viewY);
+        }
+
+        // draw polygons
+        for (auto &polygon : map.polygons)
+        {
+            if (polygon.IsEmpty())
+                continue;
 
-                for (uint8_t y = 0; y < sandtrap.height; y += SandtrapSpriteHeight)
-                {
-                    int16_t drawY = y + sandtrap.y - _cameraY;
-                    if (drawY < -(int8_t)SandtrapSpriteHeight || drawY > HEIGHT)
-                        continue;
+            int16_t centerX = polygon.center.x - viewX;
+            int16_t centerY = polygon.center.y - viewY;
+            if (centerX + polygon.radius < 0 || centerX - polygon.radius > WIDTH ||
+                centerY + polygon.radius < 0 || centerY - polygon.radius > HEIGHT)
+                continue;
 
-                    FX::drawBitmap(drawX, drawY, SandtrapSprite, 0, dbmNormal);
-                }
+            for (uint8_t i = 0; i < polygon.vertexCount; i++)
+            {
+                const Point8 &p1 = polygon.vertices[i];
+                const Point8 &p2 = polygon.vertices[(i + 1) % polygon.vertexCount];
+                _arduboy.drawLine(p1.x - viewX, p1.y - viewY, p2.x - viewX, p2.y - viewY);
             }
         }
 
-        // draw walls
-        for (auto wall : map.walls)
+        // draw moving obstacles at the current mover clock, skipping those off screen
+        for (auto mover : map.movers)
         {
-            if (wall.IsEmpty())
+            if (mover.IsEmpty())
+                continue;
+
+            Bounds bounds = Movers::GetBounds(mover);
+            if (bounds.right < viewX || bounds.left >= viewX + WIDTH || bounds.bottom < viewY || bounds.top >= viewY + HEIGHT)
                 continue;
 
-            _arduboy.drawLine(wall.p1.x - _cameraX,
-                              wall.p1.y - _cameraY,
-                              wall.p2.x - _cameraX,
-                              wall.p2.y - _cameraY);
+            Segment segments[Movers::MaxSegments];
+            uint8_t count = Movers::GetSegments(mover, moverTick, segments);
+            for (uint8_t i = 0; i < count; i++)
+            {
+                _arduboy.drawLine(segments[i].x1 - viewX, segments[i].y1 - viewY,
+                                  segments[i].x2 - viewX, segments[i].y2 - viewY);
+            }
+
+            if (mover.type == MoverType::Rotor)
+                _arduboy.fillCircle(mover.a.x - viewX, mover.a.y - viewY, 1);
         }
+    }
+
+    // Debug view of the map's slopes and wind: an arrow per cell, pointing where the ball
+    // is pushed, with a length of a quarter of the acceleration
+    void DrawForceField(const Map &map)
+    {
+        if (map.forces == 0)
+            return;
+
+        int16_t right, bottom;
+        if (!GetVisibleGrid(ForceField::GridColumns * ForceField::CellSize, ForceField::GridRows * ForceField::CellSize, right, bottom))
+            return;
 
-        // cycle sprite frames
-        if (_arduboy.everyXFrames(5))
-            _treadmillFrame = ++_treadmillFrame % TreadmillUpSpriteFrames;
+        uint8_t firstColumn = max(_cameraX, 0) >> ForceField::CellShift;
+        uint8_t firstRow = max(_cameraY, 0) >> ForceField::CellShift;
+        uint8_t lastColumn = right >> ForceField::CellShift;
+        uint8_t lastRow = bottom >> ForceField::CellShift;
+        int8_t rowForces[ForceField::RowBytes];
+
+        for (uint8_t row = firstRow; row <= lastRow; row++)
+        {
+            ForceField::ReadRow(map.forces, row, firstColumn, rowForces, lastColumn - firstColumn + 1);
+            int16_t centerY = (row << ForceField::CellShift) + ForceField::CellSize / 2 - _cameraY;
+
+            for (uint8_t column = firstColumn; column <= lastColumn; column++)
+            {
+                int8_t forceX = rowForces[(column - firstColumn) * 2];
+                int8_t forceY = rowForces[(column - firstColumn) * 2 + 1];
+                if (forceX == 0 && forceY == 0)
+                    continue;
+
+                int16_t centerX = (column << ForceField::CellShift) + ForceField::CellSize / 2 - _cameraX;
+                int16_t tipX = centerX + constrain(forceX / 4, -MaxForceArrowLength, MaxForceArrowLength);
+                int16_t tipY = centerY + constrain(forceY / 4, -MaxForceArrowLength, MaxForceArrowLength);
+
+                _arduboy.drawLine(centerX, centerY, tipX, tipY);
+                _arduboy.fillRect(tipX - 1, tipY - 1, 2, 2);
+            }
+        }
     }
 
-    void DrawHole(uint8_t x, uint8_t y, bool withFlag = false)
+    void DrawHole(uint16_t x, uint16_t y, bool withFlag = false)
     {
         if (withFlag)
         {
@@ -187,63 +295,82 @@ public:
                            y - _cameraY + HoleNoFlagYOffset,
                            HoleNoFlagSprite, _holeFrame, dbmMasked);
         }
+    }
+
+    // Balls of the players waiting for their turn are drawn hollow
+    void DrawBall(const Ball &ball, bool active = true)
+    {
+        int16_t x = static_cast<int16_t>(ball.X) - _cameraX;
+        int16_t y = static_cast<int16_t>(ball.Y) - _cameraY;
 
-        if (_arduboy.everyXFrames(15))
-            _holeFrame = ++_holeFrame % HoleNoFlagSpriteFrames;
+        if (active)
+            _arduboy.fillCircle(x, y, Ball::Radius);
+        else
+            _arduboy.drawCircle(x, y, Ball::Radius);
     }
 
-    void DrawBall(const Ball &ball)
+    // Ball of the personal-best round, with every other pixel lit so it reads as a dimmer
+    // ball. The checkerboard follows map coordinates, so it doesn't shimmer as the camera moves.
+    void DrawGhostBall(int16_t x, int16_t y)
     {
-        _arduboy.fillCircle(static_cast<int16_t>(ball.X) - _cameraX,
-                            static_cast<int16_t>(ball.Y) - _cameraY,
-                            Ball::Radius);
+        for (int8_t dy = -Ball::Radius; dy <= Ball::Radius; dy++)
+        {
+            for (int8_t dx = -Ball::Radius; dx <= Ball::Radius; dx++)
+            {
+                if (dx * dx + dy * dy <= Ball::Radius * Ball::Radius && ((x + dx + y + dy) & 1) == 0)
+                    _arduboy.drawPixel(x + dx - _cameraX, y + dy - _cameraY);
+            }
+        }
     }
 
     void DrawAimHud(const Ball &ball)
     {
-        float lineLength = map(ball.Power, Ball::MinPower, Ball::MaxPower, MinPowerLineLength, MaxPowerLineLength);
-
-        float x = ball.X + cos(ball.Direction) * lineLength;
-        float y = ball.Y + -(sin(ball.Direction) * lineLength);
+        Vector end = GetAimEnd(ball);
 
         _arduboy.drawLine(ball.X - _cameraX,
                           ball.Y - _cameraY,
-                          x - _cameraX,
-                          y - _cameraY);
+                          end.x - _cameraX,
+                          end.y - _cameraY);
     }
 
-    void DrawStartScreen(uint8_t optionIdx)
+    void DrawStartScreen(uint8_t optionIdx, const char *courseName, uint8_t numPlayers)
     {
         _font4x6.setCursor(0, 0);
 
         for (uint8_t i = 0; i < StartScreenNumOptions; i++)
         {
-            if (i == optionIdx)
-                _font4x6.println(String(F(">")) + StartMenuTextOptions[i]);
-            else
-                _font4x6.println(String(F(" ")) + StartMenuTextOptions[i]);
+            String option = String(i == optionIdx ? F(">") : F(" ")) + UIText::Read(UIText::StartMenuOptions + i);
+            if (i == StartScreenCourseOptionIdx)
+                option += courseName;
+            if (i == StartScreenPlayersOptionIdx)
+                option += numPlayers;
+
+            _font4x6.println(option);
         }
 
         DrawMenuBackgroundAnimation();
     }
 
-    void DrawHoleSelection(uint8_t holeIdx)
+    void DrawHoleSelection(const Course &course, uint8_t holeIdx)
     {
-        // scroll lines as holeIdx changes
-        uint8_t baseHeight = 0;
-        uint8_t height = baseHeight - ((FontHeight + 1) * holeIdx);
-
-        // stop scrolling if we're towards the end of the list
-        uint8_t numEntriesFitOnScreen = 5;
-        if (holeIdx >= MapManager::NumMaps - numEntriesFitOnScreen)
-            height = baseHeight - (FontHeight + 1) * (MapManager::NumMaps - numEntriesFitOnScreen);
-
-        _font4x6.setCursor(0, height);
-
-        uint8_t holeNum = 1;
-        for (uint8_t i = 0; i < MapManager::NumMaps; i++, holeNum++)
+        _font4x6.setCursor(0, 0);
+        _font4x6.println(String(F("< ")) + course.name + F(" >"));
+
+        // the selected hole leads the list until the end of the course is on screen.
+        // Only the names of the listed holes are read from FX.
+        uint8_t numEntriesFitOnScreen = 4;
+        uint8_t firstIdx = holeIdx;
+        if (course.numHoles < numEntriesFitOnScreen)
+            firstIdx = 0;
+        else if (firstIdx > course.numHoles - numEntriesFitOnScreen)
+            firstIdx = course.numHoles - numEntriesFitOnScreen;
+        uint8_t endIdx = min(firstIdx + numEntriesFitOnScreen, course.numHoles);
+
+        char name[MapManager::MapNameLength];
+        for (uint8_t i = firstIdx; i < endIdx; i++)
         {
-            auto holeNumAndName = holeNum + String(F(": ")) + MapManager::MapNames[i];
+            MapManager::ReadMapName(MapManager::GetMapIndex(course, i), name);
+            auto holeNumAndName = (i + 1) + String(F(": ")) + name;
 
             if (i == holeIdx)
                 _font4x6.println(String(F(">")) + holeNumAndName);
@@ -256,25 +383,22 @@ public:
 
     void DrawInstructions(uint8_t pageIdx)
     {
-        FX::drawBitmap(0, 0, InstructionsSprite, pageIdx, dbmNormal);
+        DrawBackground(InstructionsSprite, pageIdx);
 
         // draw indicator 'arrows' for changing pages
-        if (_textFlashToggle)
+        if (_pageArrowFlashToggle)
         {
             if (pageIdx > 0)
             {
                 _font4x6.setCursor(0, HEIGHT - FontHeight);
-                _font4x6.print("<");
+                _font4x6.print(F("<"));
             }
             if (pageIdx < InstructionsSpriteFrames - 1)
             {
                 _font4x6.setCursor(WIDTH - FontWidth, HEIGHT - FontHeight);
-                _font4x6.print(">");
+                _font4x6.print(F(">"));
             }
         }
-
-        if (_arduboy.everyXFrames(45))
-            _textFlashToggle = !_textFlashToggle;
     }
 
     void DrawMenuBackgroundAnimation()
@@ -282,156 +406,468 @@ public:
         // draw ground and flag pole
         FX::drawBitmap(0, 0, StartScreenGroundAndPoleSprite, 0, dbmMasked);
         FX::drawBitmap(100, 11, StartScreenFlagWaveSprite, _startScreenFlagWaveFrame, dbmNormal);
-
-        if (_arduboy.everyXFrames(8))
-        {
-            // iterate forward/backward through dog tail wag frames
-            _startScreenFlagWaveFrame += _startScreenFlagWaveFrameIncreasing;
-            if (_startScreenFlagWaveFrame >= StartScreenFlagWaveSpriteFrames - 1)
-                _startScreenFlagWaveFrameIncreasing = -1;
-            else if (_startScreenFlagWaveFrame <= 0)
-                _startScreenFlagWaveFrameIncreasing = 1;
-        }
     }
 
     void DrawMapSummary(uint8_t mapNum, const Map &map)
     {
-        _font4x6.setCursor(0, 20);
-        PrintCenteredWithBackground(String(F("Hole ")) + mapNum + String(F("\n")) +
-                                    F("\"") + map.name + F("\"") +
-                                    String(F("\npar ")) + String(map.par));
+        FX::drawBitmap(UIPanels::MapSummary::X, UIPanels::MapSummary::Y, MapSummaryPanel, _borderFlickerToggle, dbmMasked);
+
+        _font4x6.setCursorY(UIPanels::MapSummary::TextY);
+        PrintlnCentered(String(UIText::Read(UIText::Hole)) + mapNum);
+        PrintlnCentered(String(F("\"")) + map.name + F("\""));
+        PrintlnCentered(String(UIText::Read(UIText::Par)) + map.par);
+    }
+
+    // Shown on the hole summary panel while an endless mode hole is being built
+    void DrawGeneratingHole(uint8_t holeNum)
+    {
+        FX::drawBitmap(UIPanels::MapSummary::X, UIPanels::MapSummary::Y, MapSummaryPanel, _borderFlickerToggle, dbmMasked);
+
+        _font4x6.setCursorY(UIPanels::MapSummary::TextY);
+        PrintlnCentered(String(UIText::Read(UIText::Hole)) + holeNum);
+        PrintlnCentered(UIText::Read(UIText::Generating));
     }
 
     void DrawMapExplorerIndicator()
     {
-        if (_arduboy.everyXFrames(30))
-            _textFlashToggle = !_textFlashToggle;
+        if (_textFlashToggle)
+            DrawTextBottomLeft(UIText::Read(UIText::ViewMap));
+    }
+
+    // The whole map at 1 / 2^zoomShift of its size, from the overview bitmaps prerendered
+    // by Assets/generate_overviews.py (one frame per map in Maps order). A map that is still
+    // larger than the screen at that scale scrolls with the camera. The ball, its aim and the
+    // hole are drawn over it at the same scale.
+    void DrawOverview(uint8_t mapIndex, uint8_t zoomShift, const Map &map, const Ball &ball)
+    {
+        int16_t left = GetOverviewOffset(_cameraX + HalfScreenWidth, _mapWidth, WIDTH, zoomShift);
+        int16_t top = GetOverviewOffset(_cameraY + HalfScreenHeight, _mapHeight, HEIGHT, zoomShift);
+        FX::drawBitmap(left, top, zoomShift == 1 ? MapOverviewHalf : MapOverviewQuarter, mapIndex, dbmNormal);
+
+        int16_t ballX = left + (static_cast<int16_t>(ball.X) >> zoomShift);
+        int16_t ballY = top + (static_cast<int16_t>(ball.Y) >> zoomShift);
+        // ::map, as the Map parameter hides Arduino's map()
+        float lineLength = ::map(ball.Power, Ball::MinPower, Ball::MaxPower, MinPowerLineLength, MaxPowerLineLength) / (1 << zoomShift);
+        _arduboy.drawLine(ballX, ballY, ballX + cos(ball.Direction) * lineLength, ballY - sin(ball.Direction) * lineLength);
+        _arduboy.fillCircle(ballX, ballY, 1);
+        _arduboy.drawCircle(left + (map.end.x >> zoomShift), top + (map.end.y >> zoomShift), 2);
 
         if (_textFlashToggle)
-            DrawTextBottomLeft("View Map");
+            DrawTextBottomLeft(String(UIText::Read(UIText::ViewMap)) + F(" 1/") + (1 << zoomShift));
+    }
+
+    // Picks the corner of the minimap for this frame, before DrawMap(): the top right one,
+    // unless the ball or its aim line reach into it and not into the bottom right one. The
+    // left corners hold the player and map explorer indicators.
+    void PlaceMinimap(const Ball &ball)
+    {
+        Vector end = GetAimEnd(ball);
+        int16_t left = min(ball.X, end.x) - _cameraX - Ball::Radius;
+        int16_t right = max(ball.X, end.x) - _cameraX + Ball::Radius;
+        int16_t top = min(ball.Y, end.y) - _cameraY - Ball::Radius;
+        int16_t bottom = max(ball.Y, end.y) - _cameraY + Ball::Radius;
+
+        bool inTop = right >= MinimapX && top < MinimapTopY + MapThumbnailHeight && bottom >= MinimapTopY;
+        bool inBottom = right >= MinimapX && top < MinimapBottomY + MapThumbnailHeight && bottom >= MinimapBottomY;
+        _minimapY = inTop && !inBottom ? MinimapBottomY : MinimapTopY;
+    }
+
+    // The whole map stretched into a right corner (see PlaceMinimap()), from its thumbnail
+    // prerendered by Assets/generate_overviews.py, with a pixel each for the ball and the
+    // hole blinking in turn. The thumbnail is opaque, see DrawMap's withMinimap.
+    void DrawMinimap(uint8_t mapIndex, const Map &map, const Ball &ball)
+    {
+        FX::drawBitmap(MinimapX, _minimapY, MapThumbnail, mapIndex, dbmNormal);
+
+        _arduboy.drawPixel(GetMinimapX(static_cast<uint16_t>(ball.X)), GetMinimapY(static_cast<uint16_t>(ball.Y)), _textFlashToggle ? WHITE : BLACK);
+        _arduboy.drawPixel(GetMinimapX(map.end.x), GetMinimapY(map.end.y), _textFlashToggle ? BLACK : WHITE);
     }
 
     void DrawPauseMenu(uint8_t mapNum, const Map &map, uint8_t strokes, uint8_t optionIdx)
     {
-        // print "Paused" in top left corner with a border
-        auto pausedText = "Paused";
-        _font4x6.setCursor(2, 1);
-        Rect bgRect = Rect(1, 1, GetTextPixelWidth(pausedText) + 2, FontHeight + 1);
-        Rect borderRect = ExpandRect(bgRect, 1);
-        DrawDottedBorder(borderRect);
-        _arduboy.fillRect(bgRect.x, bgRect.y, bgRect.width, bgRect.height, BLACK);
-        _font4x6.print(pausedText);
+        DrawBackground(PauseMenuPanel, _borderFlickerToggle);
 
-        // map info summary
-        _font4x6.setCursor(64, 0);
-        _font4x6.println(String(F("   Hole ")) + mapNum);
-        _font4x6.println(String(F("par:      ")) + map.par);
-        _font4x6.println(String(F("strokes:  ")) + strokes);
+        PrintAt(UIPanels::PauseMenu::HoleSlotX, UIPanels::PauseMenu::HoleSlotY, GetHoleSlotNumber(mapNum));
+        PrintAt(UIPanels::PauseMenu::ParSlotX, UIPanels::PauseMenu::ParSlotY, map.par);
+        PrintAt(UIPanels::PauseMenu::StrokesSlotX, UIPanels::PauseMenu::StrokesSlotY, strokes);
 
-        // menu options
-        _font4x6.setCursor(0, 48);
-        for (uint8_t i = 0; i < PauseScreenNumOptions; i++)
-        {
-            if (i == optionIdx)
-                _font4x6.println(String(F(">")) + PauseMenuTextOptions[i]);
-            else
-                _font4x6.println(String(F(" ")) + PauseMenuTextOptions[i]);
-        }
+        // selected menu option
+        _font4x6.setCursor(UIPanels::PauseMenu::OptionsX, UIPanels::PauseMenu::OptionsY + (FontHeight + 1) * optionIdx);
+        _font4x6.print(F(">"));
     }
 
-    void DrawDoubleSpeedIndicator()
+    // speed is the playback multiplier, or InstantSpeed
+    void DrawFastForwardIndicator(uint8_t speed)
     {
-        if (_arduboy.everyXFrames(30))
-            _textFlashToggle = !_textFlashToggle;
+        if (!_textFlashToggle)
+            return;
 
-        if (_textFlashToggle)
-            DrawTextBottomLeft("2x");
+        if (speed == InstantSpeed)
+            DrawTextBottomLeft(F(">>"));
+        else
+            DrawTextBottomLeft(String(speed) + F("x"));
+    }
+
+    void DrawPlayerIndicator(uint8_t playerNum)
+    {
+        DrawTextBox(1, 1, String(F("P")) + playerNum);
+    }
+
+    // Strokes and running over/under par of every player. mapNum = 0 for the end of the game,
+    // in which case strokes are the totals of the whole course.
+    void DrawScorecard(uint8_t mapNum, const int16_t *strokes, const int16_t *overUnder, uint8_t numPlayers)
+    {
+        uint8_t lineHeight = FontHeight + 1;
+        Rect rect = Rect(ScorecardX, ScorecardY, ScorecardWidth, (numPlayers + 1) * lineHeight + 6);
+        DrawDottedBorder(rect);
+
+        _font4x6.setCursorY(rect.y + 3);
+        if (mapNum == 0)
+            PrintlnCentered(UIText::Read(UIText::Final));
+        else
+            PrintlnCentered(String(UIText::Read(UIText::Hole)) + mapNum);
+
+        for (uint8_t p = 0; p < numPlayers; p++)
+        {
+            uint8_t y = rect.y + 3 + (p + 1) * lineHeight;
+            _font4x6.setCursor(rect.x + 4, y);
+            _font4x6.print(String(F("P")) + (p + 1));
+            PrintAt(rect.x + 26, y, strokes[p]);
+            PrintAt(rect.x + 48, y, overUnder[p], true);
+        }
     }
 
-    void DrawMapComplete(uint8_t mapNum, const Map &map, uint8_t strokes, int8_t totalOverUnder)
+    void DrawMapComplete(uint8_t mapNum, uint8_t par, uint8_t strokes, int8_t totalOverUnder)
     {
-        String gameTotal = String(F("game total: "));
-        if (totalOverUnder > 0)
-            gameTotal += "+";
-        gameTotal += totalOverUnder;
+        FX::drawBitmap(UIPanels::MapComplete::X, UIPanels::MapComplete::Y, MapCompletePanel, _borderFlickerToggle, dbmMasked);
 
-        _font4x6.setCursorY(8);
-        PrintCenteredWithBackground(String(F("Hole ")) + mapNum + F((" Complete!\n")) +
-                                    String(F("par:     ")) + map.par + String(F("\n")) +
-                                    String(F("strokes: ")) + String(strokes) + String(F("\n\n")) +
-                                    gameTotal +
-                                    String(F("\nPress A to continue")));
+        PrintAt(UIPanels::MapComplete::HoleSlotX, UIPanels::MapComplete::HoleSlotY, GetHoleSlotNumber(mapNum));
+        PrintAt(UIPanels::MapComplete::ParSlotX, UIPanels::MapComplete::ParSlotY, par);
+        PrintAt(UIPanels::MapComplete::StrokesSlotX, UIPanels::MapComplete::StrokesSlotY, strokes);
+        PrintAt(UIPanels::MapComplete::TotalSlotX, UIPanels::MapComplete::TotalSlotY, totalOverUnder, true);
     }
 
     void DrawMapCompleteNoTotal(uint8_t mapNum, const Map &map, uint8_t strokes)
     {
-        _font4x6.setCursorY(10);
-        PrintCenteredWithBackground(String(F("Hole ")) + mapNum + F((" Complete!\n")) +
-                                    String(F("par:     ")) + map.par + String(F("\n")) +
-                                    String(F("strokes: ")) + String(strokes) +
-                                    String(F("\nPress A to continue")));
+        FX::drawBitmap(UIPanels::MapCompleteNoTotal::X, UIPanels::MapCompleteNoTotal::Y, MapCompleteNoTotalPanel, _borderFlickerToggle, dbmMasked);
+
+        PrintAt(UIPanels::MapCompleteNoTotal::HoleSlotX, UIPanels::MapCompleteNoTotal::HoleSlotY, GetHoleSlotNumber(mapNum));
+        PrintAt(UIPanels::MapCompleteNoTotal::ParSlotX, UIPanels::MapCompleteNoTotal::ParSlotY, map.par);
+        PrintAt(UIPanels::MapCompleteNoTotal::StrokesSlotX, UIPanels::MapCompleteNoTotal::StrokesSlotY, strokes);
     }
 
     void DrawGameSummary(uint16_t totalStrokes, uint8_t totalPar)
     {
         int8_t totalOverUnder = totalStrokes - totalPar;
 
-        String gameTotal = String(F("Total:   "));
-        if (totalOverUnder > 0)
-            gameTotal += "+";
-        gameTotal += totalOverUnder;
+        FX::drawBitmap(UIPanels::GameSummary::X, UIPanels::GameSummary::Y, GameSummaryPanel, _borderFlickerToggle, dbmMasked);
 
-        _font4x6.setCursorY(7);
-        PrintCenteredWithBackground(String(F("All Holes Complete!\n\n")) +
-                                    String(F("Final Score\n")) +
-                                    String(F("Par:     ")) + totalPar + String(F("\n")) +
-                                    String(F("Strokes: ")) + totalStrokes + String(F("\n")) +
-                                    gameTotal);
+        PrintAt(UIPanels::GameSummary::ParSlotX, UIPanels::GameSummary::ParSlotY, totalPar);
+        PrintAt(UIPanels::GameSummary::StrokesSlotX, UIPanels::GameSummary::StrokesSlotY, totalStrokes);
+        PrintAt(UIPanels::GameSummary::TotalSlotX, UIPanels::GameSummary::TotalSlotY, totalOverUnder, true);
     }
 
-    void MoveUp()
+    // Advances every sprite animation and flashing element. Runs every frame, even when
+    // Display() is skipped, so animations keep their speed at any frame rate.
+    // ticks = number of full-frame-rate frames that elapsed since the last call.
+    void TickAnimations(uint8_t ticks)
     {
-        _cameraY -= 2;
-        KeepInBounds();
+        for (uint8_t i = 0; i < ticks; i++)
+        {
+            ++_animationTick;
+
+            if (_animationTick % 5 == 0)
+                _treadmillFrame = (_treadmillFrame + 1) % TreadmillUpSpriteFrames;
+
+            if (_animationTick % 15 == 0)
+                _holeFrame = (_holeFrame + 1) % HoleNoFlagSpriteFrames;
+
+            if (_animationTick % 8 == 0)
+            {
+                // iterate forward/backward through flag wave frames
+                _startScreenFlagWaveFrame += _startScreenFlagWaveFrameIncreasing;
+                if (_startScreenFlagWaveFrame >= StartScreenFlagWaveSpriteFrames - 1)
+                    _startScreenFlagWaveFrameIncreasing = -1;
+                else if (_startScreenFlagWaveFrame <= 0)
+                    _startScreenFlagWaveFrameIncreasing = 1;
+            }
+
+            if (_animationTick % 10 == 0)
+                _borderFlickerToggle = !_borderFlickerToggle;
+
+            if (_animationTick % 30 == 0)
+                _textFlashToggle = !_textFlashToggle;
+
+            if (_animationTick % 45 == 0)
+                _pageArrowFlashToggle = !_pageArrowFlashToggle;
+        }
     }
 
-    void MoveDown()
+    // Packs the animation frames of the requested layers (AnimationLayer flags) so
+    // callers can tell whether anything visible has changed since the last frame
+    uint16_t GetAnimationState(uint8_t layers) const
     {
-        _cameraY += 2;
-        KeepInBounds();
+        uint16_t state = 0;
+
+        if (layers & AnimationLayer::Map)
+            state |= _treadmillFrame | (_holeFrame << 3);
+        if (layers & AnimationLayer::MenuFlag)
+            state |= _startScreenFlagWaveFrame << 5;
+        if (layers & AnimationLayer::Border)
+            state |= _borderFlickerToggle << 8;
+        if (layers & AnimationLayer::TextFlash)
+            state |= _textFlashToggle << 9;
+        if (layers & AnimationLayer::PageArrows)
+            state |= _pageArrowFlashToggle << 10;
+
+        return state;
     }
 
-    void MoveLeft()
+    int16_t GetX() const
     {
-        _cameraX -= 2;
-        KeepInBounds();
+        return _cameraX;
+    }
+
+    int16_t GetY() const
+    {
+        return _cameraY;
     }
 
-    void MoveRight()
+    // Sends the screen buffer to the OLED. If a full-screen background was requested this
+    // frame, it is read from FX into the buffer during the same transfer so the next
+    // frame starts with it already drawn. Otherwise the buffer is cleared during the transfer.
+    void PresentFrame()
     {
-        _cameraX += 2;
+        if (_nextBackground != 0)
+        {
+            FX::displayPrefetch(_nextBackground, Arduboy2Base::sBuffer, ScreenBufferSize, false);
+            _prefetchedBackground = _nextBackground;
+            _nextBackground = 0;
+        }
+        else
+        {
+            FX::display(!_holdFrame);
+            _prefetchedBackground = 0;
+        }
+
+        _frameHeld = _holdFrame;
+        _holdFrame = false;
+    }
+
+    // Keeps this frame in the screen buffer once it's presented, so the next frame can draw
+    // over it instead of starting from a blank screen
+    void HoldFrame()
+    {
+        _holdFrame = true;
+    }
+
+    // Call at the start of any frame that doesn't draw over the held one
+    void DiscardHeldFrame()
+    {
+        if (_frameHeld)
+        {
+            _arduboy.clear();
+            _frameHeld = false;
+        }
+    }
+
+    // A prefetched background is only valid for the screen that requested it.
+    // Call at the start of any frame that doesn't draw one.
+    void DiscardPrefetchedBackground()
+    {
+        if (_prefetchedBackground != 0)
+        {
+            _arduboy.clear();
+            _prefetchedBackground = 0;
+        }
+    }
+
+    // Scrolls the map explorer in the held direction (-1, 0 or 1 on each axis), speeding up
+    // from MinPanSpeed to MaxPanSpeed pixels per frame the longer it is held. Changing the
+    // direction starts again from MinPanSpeed.
+    void Pan(int8_t dx, int8_t dy)
+    {
+        if (dx != _panX || dy != _panY)
+        {
+            _panFrames = 0;
+            _panX = dx;
+            _panY = dy;
+        }
+
+        if (dx == 0 && dy == 0)
+            return;
+
+        uint8_t speed = MinPanSpeed << (_panFrames / PanRampFrames);
+        if (speed < MaxPanSpeed)
+            _panFrames++;
+
+        _cameraX += dx * speed;
+        _cameraY += dy * speed;
         KeepInBounds();
     }
 
 private:
+    // One frame of Follow() along an axis: a 1 / 2^EaseShift of the way to the target, in
+    // multiples of `unit` pixels while the target is at least that far
+    static int16_t Ease(int16_t position, int16_t target, uint8_t unit)
+    {
+        int16_t delta = target - position;
+        if (delta == 0)
+            return position;
+        if (abs(delta) < unit)
+            unit = 1;
+
+        int16_t step = (delta >> EaseShift) / unit * unit;
+        if (step == 0)
+            step = delta > 0 ? unit : -unit;
+
+        return position + constrain(step, -MaxScrollStep, MaxScrollStep);
+    }
+
     void KeepInBounds()
     {
-        int16_t maxX = _mapWidth - WIDTH + MaxBoundaryPadding;
-        int16_t maxY = _mapHeight - HEIGHT + MaxBoundaryPadding;
+        int16_t maxX = static_cast<int16_t>(_mapWidth) - WIDTH + MaxBoundaryPadding;
+        int16_t maxY = static_cast<int16_t>(_mapHeight) - HEIGHT + MaxBoundaryPadding;
 
+        // the vertical bounds aren't on whole pages, so a camera stopped by one goes on to the
+        // next page boundary, keeping the page aligned drawing of Follow(). Rounding outward
+        // keeps a ball against the map's edge on screen.
         if (_cameraX > maxX)
             _cameraX = maxX;
         if (_cameraY > maxY)
-            _cameraY = maxY;
+            _cameraY = (maxY + PageHeight - 1) & ~(PageHeight - 1);
         if (_cameraX < -MaxBoundaryPadding)
             _cameraX = -MaxBoundaryPadding;
         if (_cameraY < -MaxBoundaryPadding)
-            _cameraY = -MaxBoundaryPadding;
+            _cameraY = -MaxBoundaryPadding & ~(PageHeight - 1);
+    }
+
+    // Screen position of a map position on the minimap, as the thumbnails are stretched
+    uint8_t GetMinimapX(uint16_t x) const
+    {
+        return MinimapX + static_cast<uint32_t>(x) * MapThumbnailWidth / _mapWidth;
+    }
+
+    uint8_t GetMinimapY(uint16_t y) const
+    {
+        return _minimapY + static_cast<uint32_t>(y) * MapThumbnailHeight / _mapHeight;
+    }
+
+    // End of the aim line, in map coordinates
+    static Vector GetAimEnd(const Ball &ball)
+    {
+        float lineLength = map(ball.Power, Ball::MinPower, Ball::MaxPower, MinPowerLineLength, MaxPowerLineLength);
+        return {ball.X + cos(ball.Direction) * lineLength, ball.Y - sin(ball.Direction) * lineLength};
+    }
+
+    // Screen position of the overview's left (or top) edge along an axis: centered if the
+    // scaled map fits on screen, otherwise centered on the camera as far as the map allows
+    static int16_t GetOverviewOffset(int16_t center, uint16_t mapSize, uint8_t screenSize, uint8_t zoomShift)
+    {
+        int16_t size = mapSize >> zoomShift;
+        if (size <= screenSize)
+            return (screenSize - size) / 2;
+
+        return -constrain((center >> zoomShift) - screenSize / 2, 0, size - screenSize);
+    }
+
+    // Last visible pixel column and row of a grid covering the top left of the map. Returns
+    // false if none of it is on screen.
+    bool GetVisibleGrid(int16_t gridWidth, int16_t gridHeight, int16_t &right, int16_t &bottom)
+    {
+        right = min(min(_cameraX + WIDTH, static_cast<int16_t>(_mapWidth)), gridWidth) - 1;
+        bottom = min(min(_cameraY + HEIGHT, static_cast<int16_t>(_mapHeight)), gridHeight) - 1;
+        return right >= max(_cameraX, 0) && bottom >= max(_cameraY, 0);
+    }
+
+    // Draws the visible terrain cells, one row per FX read. The grid covers the top left
+    // 256x256 pixels; the rest of a larger map is plain floor.
+    void DrawTerrain(const Map &map, bool withMinimap)
+    {
+        int16_t right, bottom;
+        if (!GetVisibleGrid(Terrain::GridColumns * Terrain::CellSize, Terrain::GridRows * Terrain::CellSize, right, bottom))
+            return;
+
+        uint8_t firstColumn = max(_cameraX, 0) >> Terrain::CellShift;
+        uint8_t firstRow = max(_cameraY, 0) >> Terrain::CellShift;
+        uint8_t lastColumn = right >> Terrain::CellShift;
+        uint8_t lastRow = bottom >> Terrain::CellShift;
+        uint8_t firstByte = firstColumn / 2;
+        uint8_t rowCells[Terrain::RowBytes];
+
+        for (uint8_t row = firstRow; row <= lastRow; row++)
+        {
+            Terrain::ReadRow(map.terrain, row, firstByte, rowCells, lastColumn / 2 - firstByte + 1);
+            int16_t drawY = (row << Terrain::CellShift) - _cameraY;
+
+            for (uint8_t column = firstColumn; column <= lastColumn; column++)
+            {
+                uint8_t material = Terrain::GetCell(rowCells, column - 2 * firstByte);
+                if (material == MaterialId::Default)
+                    continue;
+
+                int16_t drawX = (column << Terrain::CellShift) - _cameraX;
+                if (withMinimap && IsUnderMinimap(drawX, drawY, Terrain::CellSize, Terrain::CellSize))
+                    continue;
+
+                DrawTerrainCell(drawX, drawY, Materials::Get(material).sprite);
+            }
+        }
+    }
+
+    // True if a rectangle of the screen is entirely covered by the minimap
+    bool IsUnderMinimap(int16_t x, int16_t y, int16_t width, int16_t height) const
+    {
+        return x >= MinimapX && x + width <= WIDTH && y >= _minimapY && y + height <= _minimapY + MapThumbnailHeight;
+    }
+
+    void DrawTerrainCell(int16_t x, int16_t y, TerrainSprite sprite)
+    {
+        switch (sprite)
+        {
+            case TerrainSprite::None:
+                _arduboy.drawRect(x, y, Terrain::CellSize, Terrain::CellSize, WHITE);
+                break;
+            case TerrainSprite::Sand:
+                FX::drawBitmap(x, y, SandtrapSprite, 0, dbmNormal);
+                break;
+            case TerrainSprite::TreadmillUp:
+                FX::drawBitmap(x, y, TreadmillUpSprite, _treadmillFrame, dbmNormal);
+                break;
+            case TerrainSprite::TreadmillDown:
+                FX::drawBitmap(x, y, TreadmillDownSprite, _treadmillFrame, dbmNormal);
+                break;
+            case TerrainSprite::TreadmillLeft:
+                FX::drawBitmap(x, y, TreadmillLeftSprite, _treadmillFrame, dbmNormal);
+                break;
+            case TerrainSprite::TreadmillRight:
+                FX::drawBitmap(x, y, TreadmillRightSprite, _treadmillFrame, dbmNormal);
+                break;
+        }
+    }
+
+    // Draws a frame of a full-screen (unmasked) FX image and requests that it be
+    // prefetched into the screen buffer for the next frame
+    void DrawBackground(uint24_t image, uint8_t frame)
+    {
+        uint24_t frameAddress = image + FXImageHeaderSize + static_cast<uint24_t>(frame) * ScreenBufferSize;
+
+        // background wasn't prefetched (first frame on this screen, or the page changed)
+        if (_prefetchedBackground != frameAddress)
+            FX::drawBitmap(0, 0, image, frame, dbmNormal);
+
+        _nextBackground = frameAddress;
     }
 
     void DrawTextBottomLeft(const String &text)
     {
-        _font4x6.setCursor(0, HEIGHT - FontHeight - 1);
+        DrawTextBox(0, HEIGHT - FontHeight - 1, text);
+    }
+
+    // Single line of text on a black background with a dotted border
+    void DrawTextBox(uint8_t x, uint8_t y, const String &text)
+    {
+        _font4x6.setCursor(x, y);
 
         Rect bgRect = Rect(_font4x6.getCursorX() - 1,
                            _font4x6.getCursorY(),
@@ -445,44 +881,42 @@ private:
         _font4x6.print(text);
     }
 
-    // Prints the provided text centered on the screen
-    // with a checkered background
-    void PrintCenteredWithBackground(const String &text)
+    // Prints a single line of text horizontally centered on the screen
+    void PrintlnCentered(const String &text)
     {
-        Rect backgroundRect = GetBoundingRectOfCenteredText(text);
-        backgroundRect = ExpandRect(backgroundRect, 2);
-        DrawDottedBorder(backgroundRect);
-
-        int8_t lineLength = 0;
-        String temp = String(text);
-
-        do
-        {
-            lineLength = temp.indexOf('\n');
-            if (lineLength < 0)
-                lineLength = temp.length();
-
-            auto line = temp.substring(0, lineLength);
-            temp = temp.substring(lineLength + 1);
-
-            uint8_t textWidth = GetTextPixelWidth(line);
-            uint8_t offset = HalfScreenWidth - (textWidth / 2);
+        _font4x6.setCursorX(HalfScreenWidth - (GetTextPixelWidth(text) / 2));
+        _font4x6.println(text);
+    }
 
-            _font4x6.setCursorX(offset);
-            PrintlnCenteredOverBlack(line);
-        } while (temp.length() > 0);
+    // Hole number as it fits a one digit panel slot. Endless mode counts past 9, so its
+    // holes are numbered 1 to 9 within each nine, the way a golf course's back nine is.
+    static uint8_t GetHoleSlotNumber(uint8_t holeNum)
+    {
+        return (holeNum - 1) % 9 + 1;
     }
 
-    // Prints the provided text centered on the screen with a black background
-    void PrintlnCenteredOverBlack(const String &text)
+    // Prints a number into a UI panel slot
+    void PrintAt(uint8_t x, uint8_t y, int16_t value, bool withPlusSign = false)
     {
-        Rect rect = GetBoundingRectOfCenteredText(text);
-        _arduboy.fillRect(rect.x, rect.y, rect.width, rect.height, BLACK);
-        _font4x6.println(text);
+        _font4x6.setCursor(x, y);
+        if (withPlusSign && value > 0)
+            _font4x6.print(F("+"));
+        _font4x6.print(value);
     }
 
     // Draws a black rectangle on the provided Rect with a dotted border
     void DrawDottedBorder(const Rect &rect)
+    {
+        DrawDottedBorder(rect, _borderFlickerToggle);
+    }
+
+    void DrawDottedBorderNoFlicker(const Rect &rect)
+    {
+        DrawDottedBorder(rect, false);
+    }
+
+    // flickerPhase selects which of the two dot patterns is drawn
+    void DrawDottedBorder(const Rect &rect, bool flickerPhase)
     {
         _arduboy.fillRect(rect.x, rect.y, rect.width, rect.height, BLACK);
 
@@ -493,7 +927,7 @@ private:
         for (x = 0; x < rect.width; x++)
         {
             bool draw = (x % 2 == 1) ^ true;
-            if (draw == _borderFlickerToggle)
+            if (draw == flickerPhase)
                 _arduboy.drawPixel(x + rect.x, rect.y);
         }
 
@@ -502,7 +936,7 @@ private:
         {
             y = rect.height - 1;
             bool draw = (x % 2 == 1) ^ (y % 2 == 0);
-            if (draw == _borderFlickerToggle)
+            if (draw == flickerPhase)
                 _arduboy.drawPixel(x + rect.x, y + rect.y);
         }
 
@@ -510,7 +944,7 @@ private:
         for (y = 0; y < rect.height; y++)
         {
             bool draw = (y % 2 == 0) ^ false;
-            if (draw == _borderFlickerToggle)
+            if (draw == flickerPhase)
                 _arduboy.drawPixel(rect.x, y + rect.y);
         }
 
@@ -519,54 +953,9 @@ private:
         {
             x = rect.width - 1;
             bool draw = x % 2 == 1 ^ y % 2 == 0;
-            if (draw == _borderFlickerToggle)
+            if (draw == flickerPhase)
                 _arduboy.drawPixel(x + rect.x, y + rect.y);
         }
-
-        if (_arduboy.everyXFrames(10))
-            _borderFlickerToggle = !_borderFlickerToggle;
-    }
-
-    void DrawDottedBorderNoFlicker(const Rect &rect)
-    {
-        _borderFlickerToggle = false;
-        DrawDottedBorder(rect);
-    }
-
-    // Returns a Rect that represents the boundary of a block of text.
-    // Margin of 2 pixels on left/right, and margin of 1 pixel on top/bottom.
-    // Provided text can contain multiple lines.
-    Rect GetBoundingRectOfCenteredText(const String &text)
-    {
-        int8_t lineLength = 0;
-        uint8_t largestStr = 0;
-        uint8_t numLines = 0;
-        String temp = String(text);
-
-        do
-        {
-            // get next line of text
-            lineLength = temp.indexOf('\n');
-            if (lineLength < 0)
-                lineLength = temp.length();
-
-            auto line = temp.substring(0, lineLength);
-            temp = temp.substring(lineLength + 1);
-
-            largestStr = max(largestStr, line.length());
-            numLines++;
-        } while (temp.length() > 0);
-
-        uint8_t width = (largestStr * FontWidth);
-        width += largestStr - 1; // include pixel between chars
-        width += 4;              // account for 2 pixel margin on left/right
-
-        uint8_t x = (HalfScreenWidth - (width / 2));
-        uint8_t y = _font4x6.getCursorY();
-        uint8_t height = (numLines * FontHeight) + (numLines - 1);
-        height += 2; // account for 1 pixel margin on top/bottom
-
-        return Rect(x, y, width, height);
     }
 
     Rect ExpandRect(const Rect &rect, uint8_t i)
@@ -586,4 +975,9 @@ private:
     {
         _font4x6.setCursorY(_font4x6.getCursorY() + offset);
     }
-};
\ No newline at end of file
+};
+
+uint24_t Camera::_nextBackground = 0;
+uint24_t Camera::_prefetchedBackground = 0;
+bool Camera::_holdFrame = false;
+bool Camera::_frameHeld = false;
\ No newline at end of file
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Ball.h"
+#include "FX/ArduboyFX.h"
+#include "FX/fxdata.h"
+#include "Map.h"
+#include <Arduboy2.h>
+
+// Streams the obstacles of a chunked map from FX data. A chunked map is cut into
+// ChunkSize squares, each stored as a MapChunk in ObstacleChunks, and only the 2x2 chunks
+// of the active region around the camera are kept in the Map's walls and circles, one
+// chunk per slot. Collision and drawing keep iterating those arrays as
+// they do for any other map, with the region's top left corner as the Map's origin.
+//
+// The region only moves once the position gets closer than RegionMargin to one of its
+// inner edges, which keeps the screen inside it. It is picked once per frame: a ball that
+// rolls to where the obstacles past the region could reach it (see Covers()) waits for it.
+// When it moves, the chunks it still covers keep their slot and only the new ones are read
+// from FX data.
+//
+// Map authoring rules, so that no obstacle reaches past the region:
+//   - walls are split at chunk borders,
+//   - a circle belongs to the chunk of its center, with a radius of at most MaxRadius,
+//   - polygons and movers are not supported.
+class ChunkCache
+{
+public:
+    static constexpr uint8_t ChunkShift = 7;
+    static constexpr uint8_t ChunkSize = 1 << ChunkShift;
+    static constexpr uint8_t RegionChunks = 2; // the region is RegionChunks x RegionChunks chunks
+    static constexpr uint8_t Slots = RegionChunks * RegionChunks;
+    static constexpr uint8_t RegionMargin = ChunkSize / 2; // half a screen's width
+    static constexpr uint8_t MaxRadius = 24;
+
+    // How far into the region the obstacles of the chunks past it can touch a ball, with a
+    // ball's radius to spare for the step it takes before Covers() is checked again
+    static constexpr uint8_t Reach = MaxRadius + 2 * Ball::Radius;
+
+    // A region picked around a position covers a ball up to this far from it
+    static constexpr uint8_t CoverSlack = RegionMargin - Reach;
+
+    // Forgets the cached chunks. Call after loading another map into the Map.
+    void Reset()
+    {
+        for (uint8_t i = 0; i < Slots; i++)
+            _slotChunks[i] = NoChunk;
+    }
+
+    // Moves the region over the given map position if needed, reading the chunks that came
+    // into it. Returns true if the obstacles in the Map changed.
+    bool Update(Map &map, int16_t x, int16_t y)
+    {
+        if (map.chunkColumns == 0)
+            return false;
+
+        uint8_t column = PickRegion(x, map.originX >> ChunkShift, map.chunkColumns);
+        uint8_t row = PickRegion(y, map.originY >> ChunkShift, map.chunkRows);
+        uint16_t originX = static_cast<uint16_t>(column) << ChunkShift;
+        uint16_t originY = static_cast<uint16_t>(row) << ChunkShift;
+
+        // the region always fills the first slots, so an empty first slot means nothing is loaded
+        if (originX == map.originX && originY == map.originY && _slotChunks[0] != NoChunk)
+            return false;
+
+        int16_t shiftX = static_cast<int16_t>(map.originX) - originX;
+        int16_t shiftY = static_cast<int16_t>(map.originY) - originY;
+        map.originX = originX;
+        map.originY = originY;
+
+        // keep the chunks the region still covers, moved into its new coordinates
+        uint8_t present = 0;
+        for (uint8_t slot = 0; slot < Slots; slot++)
+        {
+            if (_slotChunks[slot] == NoChunk)
+                continue;
+
+            int16_t regionColumn = _slotChunks[slot] % map.chunkColumns - column;
+            int16_t regionRow = _slotChunks[slot] / map.chunkColumns - row;
+            if (regionColumn < 0 || regionColumn >= RegionChunks || regionRow < 0 || regionRow >= RegionChunks)
+            {
+                _slotChunks[slot] = NoChunk;
+                continue;
+            }
+
+            Translate(map, slot, shiftX, shiftY);
+            present |= 1 << (regionRow * RegionChunks + regionColumn);
+        }
+
+        // read the ones that came into the region into the free slots
+        uint8_t slot = 0;
+        for (uint8_t regionRow = 0; regionRow < RegionChunks && row + regionRow < map.chunkRows; regionRow++)
+        {
+            for (uint8_t regionColumn = 0; regionColumn < RegionChunks && column + regionColumn < map.chunkColumns; regionColumn++)
+            {
+                if (present & (1 << (regionRow * RegionChunks + regionColumn)))
+                    continue;
+
+                while (_slotChunks[slot] != NoChunk)
+                    slot++;
+
+                _slotChunks[slot] = (row + regionRow) * map.chunkColumns + column + regionColumn;
+                Load(map, slot, _slotChunks[slot], regionColumn * ChunkSize, regionRow * ChunkSize);
+            }
+        }
+
+        return true;
+    }
+
+    // Returns true if every obstacle that can touch a ball at the given map position is in
+    // the region, so the ball can be stepped against the Map's obstacles alone
+    bool Covers(const Map &map, int16_t x, int16_t y) const
+    {
+        if (map.chunkColumns == 0)
+            return true;
+
+        return _slotChunks[0] != NoChunk &&
+               CoversAxis(x - map.originX, map.originX >> ChunkShift, map.chunkColumns) &&
+               CoversAxis(y - map.originY, map.originY >> ChunkShift, map.chunkRows);
+    }
+
+private:
+    static constexpr uint8_t NoChunk = UINT8_MAX;
+
+    uint8_t _slotChunks[Slots]; // index of the chunk held by each slot, relative to Map::firstChunk
+
+    // First chunk of the region along one axis. The current one is kept while the position
+    // stays RegionMargin away from its inner edges, otherwise the region is centered on it.
+    static uint8_t PickRegion(int16_t position, uint8_t first, uint8_t count)
+    {
+        int16_t offset = position - (static_cast<int16_t>(first) << ChunkShift);
+        bool clearOfStart = first == 0 || offset >= RegionMargin;
+        bool clearOfEnd = first + RegionChunks >= count || offset < RegionChunks * ChunkSize - RegionMargin;
+        if (clearOfStart && clearOfEnd)
+            return first;
+
+        int16_t last = max(count - RegionChunks, 0);
+        return constrain((position - RegionMargin) >> ChunkShift, 0, last);
+    }
+
+    // Whether an offset from the region's first chunk along one axis is Reach away from the
+    // edges that have chunks past them
+    static bool CoversAxis(int16_t offset, uint8_t first, uint8_t count)
+    {
+        return (first == 0 || offset >= Reach) && (first + RegionChunks >= count || offset < RegionChunks * ChunkSize - Reach);
+    }
+
+    // Reads a chunk into a slot, at the given offset from the region's origin
+    static void Load(Map &map, uint8_t slot, uint8_t chunk, uint8_t offsetX, uint8_t offsetY)
+    {
+        uint24_t address = ObstacleChunks + static_cast<uint24_t>(map.firstChunk + chunk) * sizeof(MapChunk);
+        FX::readDataBytes(address, reinterpret_cast<uint8_t *>(&map.walls[slot * MapChunk::NumWalls]),
+                          MapChunk::NumWalls * sizeof(Wall));
+        FX::readDataBytes(address + MapChunk::NumWalls * sizeof(Wall), reinterpret_cast<uint8_t *>(&map.circles[slot * MapChunk::NumCircles]),
+                          MapChunk::NumCircles * sizeof(Circle));
+
+        Translate(map, slot, offsetX, offsetY);
+    }
+
+    // Moves the obstacles of a slot, leaving its unused entries empty
+    static void Translate(Map &map, uint8_t slot, int16_t dx, int16_t dy)
+    {
+        for (uint8_t i = slot * MapChunk::NumWalls; i < (slot + 1) * MapChunk::NumWalls; i++)
+        {
+            Wall &wall = map.walls[i];
+            if (wall.IsEmpty())
+                continue;
+
+            wall.p1 = Point8(wall.p1.x + dx, wall.p1.y + dy);
+            wall.p2 = Point8(wall.p2.x + dx, wall.p2.y + dy);
+        }
+
+        for (uint8_t i = slot * MapChunk::NumCircles; i < (slot + 1) * MapChunk::NumCircles; i++)
+        {
+            Circle &circle = map.circles[i];
+            if (circle.IsEmpty())
+                continue;
+
+            circle.location = Point8(circle.location.x + dx, circle.location.y + dy);
+        }
+    }
+};
+
+static_assert(ChunkCache::Slots * MapChunk::NumWalls <= Map::MaxNumWalls, "Map::walls must hold the walls of every slot");
+static_assert(ChunkCache::Slots * MapChunk::NumCircles <= Map::MaxNumCircles, "Map::circles must hold the circles of every slot");
+static_assert(ChunkCache::Reach < ChunkCache::RegionMargin, "a ball at the position the region is picked around must be covered");
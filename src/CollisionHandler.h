@@ -2,6 +2,8 @@
 
 #include "Ball.h"
 #include "Map.h"
+#include "Material.h"
+#include "Movers.h"
 #include <Arduboy2.h>
 
 class CollisionHandler
@@ -9,7 +11,8 @@ class CollisionHandler
     CollisionHandler() = delete; // enforce this to be a static class
 
 public:
-    static void HandleAllCollisions(Ball &ball, const Map &map, float secondsDelta)
+    // Resolves the collisions for one Ball::PhysicsStep
+    static void HandleAllCollisions(Ball &ball, const Map &map)
     {
         for (auto wall : map.walls)
         {
@@ -53,37 +56,176 @@ public:
                 HandleCollisionCircle(ball, circle);
         }
 
-        for (auto sandTrap : map.sandTraps)
+        for (auto &polygon : map.polygons)
         {
-            if (sandTrap.IsEmpty())
+            if (polygon.IsEmpty())
                 continue;
 
-            if (IsCollidingSandTrap(ball, sandTrap))
-                HandleCollisionSandTrap(ball, sandTrap, secondsDelta);
+            HandleCollisionPolygon(ball, polygon);
         }
+    }
 
-        for (auto treadmill : map.treadmills)
+    // Resolves the collisions with the moving obstacles for one Ball::PhysicsStep, during
+    // which the ball moved from (fromX, fromY) and the mover clock advanced from `tick`
+    // to `tick + 1`. Only movers whose bounds are within reach are evaluated.
+    static void HandleMovers(Ball &ball, float fromX, float fromY, const Map &map, uint16_t tick)
+    {
+        for (auto mover : map.movers)
         {
-            if (treadmill.IsEmpty())
+            if (mover.IsEmpty())
+                continue;
+
+            if (DistanceToBounds(ball, Movers::GetBounds(mover)) > Ball::Radius + MaxStepApproach)
                 continue;
 
-            if (IsCollidingTreadmill(ball, treadmill))
-                HandleCollisionTreadmill(ball, treadmill, secondsDelta);
+            Segment before[Movers::MaxSegments];
+            Segment after[Movers::MaxSegments];
+            uint8_t count = Movers::GetSegments(mover, tick, before);
+            Movers::GetSegments(mover, tick + 1, after);
+
+            for (uint8_t i = 0; i < count; i++)
+                HandleCollisionMovingSegment(ball, fromX, fromY, before[i], after[i], mover.material);
         }
     }
 
+    // Applies one Ball::PhysicsStep of the friction and push of the floor under the ball
+    // (see Terrain::GetMaterial)
+    static void HandleTerrain(Ball &ball, uint8_t materialIndex)
+    {
+        if (materialIndex == MaterialId::Default)
+            return;
+
+        const Material &material = Materials::Get(materialIndex);
+
+        // slippery materials don't add to the stop timer, the ground's step already did
+        if (material.friction != 0)
+            ball.ApplyFriction(Materials::GetDecay(materialIndex), material.friction > 0 ? Ball::PhysicsStep * material.friction / 10 : 0);
+
+        ball.Velocity.x += material.pushX * Ball::PhysicsStep;
+        ball.Velocity.y += material.pushY * Ball::PhysicsStep;
+    }
+
+    // Returns how many Ball::PhysicsSteps the ball can take before it could possibly touch
+    // anything (wall, circle, mover or hole). Those steps can skip HandleAllCollisions() and
+    // BallInHole(). Only valid while the ball is on plain ground, where it only slows down.
+    static uint8_t GetContactFreeSteps(const Ball &ball, const Map &map)
+    {
+        float freeDistance = GetFreeDistance(ball, map) - FreeDistanceMargin;
+        if (freeDistance <= 0)
+            return 0;
+
+        float stepDistance = ball.Velocity.Length() * Ball::GroundDisplacement;
+        if (stepDistance * UINT8_MAX <= freeDistance)
+            return UINT8_MAX;
+
+        return static_cast<uint8_t>(freeDistance / stepDistance);
+    }
+
     static bool BallInHole(Ball &ball, const Map &map)
     {
         float dist = Distance(ball.X, ball.Y, map.end.x, map.end.y);
         return dist <= Map::HoleRadius - .5;
     }
 
+    // Equal-mass elastic collision between two balls. Returns true if they touched, in
+    // which case both were relaunched with their new velocities.
+    static bool HandleCollisionBalls(Ball &a, Ball &b)
+    {
+        Vector aToB = {b.X - a.X, b.Y - a.Y};
+        float distanceSquared = aToB.LengthSquared();
+        if (distanceSquared > (2 * Ball::Radius) * (2 * Ball::Radius) || distanceSquared == 0)
+            return false;
+
+        // push the balls apart, half the overlap each
+        float distance = sqrt(distanceSquared);
+        Vector normal = aToB * (1 / distance);
+        float overlap = (2 * Ball::Radius - distance) / 2;
+        a.X -= normal.x * overlap;
+        a.Y -= normal.y * overlap;
+        b.X += normal.x * overlap;
+        b.Y += normal.y * overlap;
+
+        // exchange the velocity components along the normal, if they are approaching
+        float approach = (a.Velocity.x - b.Velocity.x) * normal.x + (a.Velocity.y - b.Velocity.y) * normal.y;
+        if (approach <= 0)
+            return true;
+
+        a.Launch({a.Velocity.x - approach * normal.x, a.Velocity.y - approach * normal.y});
+        b.Launch({b.Velocity.x + approach * normal.x, b.Velocity.y + approach * normal.y});
+        return true;
+    }
+
     static float Distance(float x1, float y1, float x2, float y2)
     {
         return sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
     }
 
 private:
+    static constexpr float FreeDistanceMargin = 0.5; // guards against float rounding near contacts
+    static constexpr float MaxStepApproach = 4;      // more than a ball and a blade tip can close in on each other in one step
+
+    // Distance the ball's center can travel in any direction before a contact
+    static float GetFreeDistance(const Ball &ball, const Map &map)
+    {
+        // the ball is relative to the map's origin, like the obstacles, the hole isn't
+        float freeDistance = Distance(ball.X, ball.Y, static_cast<float>(map.end.x) - map.originX, static_cast<float>(map.end.y) - map.originY) - Map::HoleRadius;
+
+        for (auto wall : map.walls)
+        {
+            if (wall.IsEmpty())
+                continue;
+
+            freeDistance = min(freeDistance, DistanceToWall(ball, wall) - Ball::Radius);
+        }
+
+        for (auto circle : map.circles)
+        {
+            if (circle.IsEmpty())
+                continue;
+
+            float distance = Distance(ball.X, ball.Y, circle.location.x, circle.location.y);
+            freeDistance = min(freeDistance, distance - circle.radius - Ball::Radius);
+        }
+
+        for (auto &polygon : map.polygons)
+        {
+            if (polygon.IsEmpty())
+                continue;
+
+            float distance = Distance(ball.X, ball.Y, polygon.center.x, polygon.center.y);
+            freeDistance = min(freeDistance, distance - polygon.radius - Ball::Radius);
+        }
+
+        for (auto mover : map.movers)
+        {
+            if (mover.IsEmpty())
+                continue;
+
+            freeDistance = min(freeDistance, DistanceToBounds(ball, Movers::GetBounds(mover)) - Ball::Radius);
+        }
+
+        return freeDistance;
+    }
+
+    static float DistanceToBounds(const Ball &ball, const Bounds &bounds)
+    {
+        float dx = max(max(bounds.left - ball.X, ball.X - bounds.right), 0.0f);
+        float dy = max(max(bounds.top - ball.Y, ball.Y - bounds.bottom), 0.0f);
+        return sqrt(dx * dx + dy * dy);
+    }
+
+    static float DistanceToWall(const Ball &ball, const Wall &wall)
+    {
+        float dx = static_cast<float>(wall.p2.x - wall.p1.x);
+        float dy = static_cast<float>(wall.p2.y - wall.p1.y);
+        float fx = ball.X - static_cast<float>(wall.p1.x);
+        float fy = ball.Y - static_cast<float>(wall.p1.y);
+
+        float t = constrain((fx * dx + fy * dy) / (dx * dx + dy * dy), 0.0, 1.0);
+
+        return Distance(ball.X, ball.Y, wall.p1.x + t * dx, wall.p1.y + t * dy);
+    }
+
     static bool IsCollidingWall(const Ball &ball, const Wall &wall)
     {
         // Wall vector
@@ -132,10 +274,7 @@ private:
             wallNormal.y = -wallNormal.y;
         }
 
-        // Reflect the ball's velocity
-        float dotProduct = ball.Velocity.DotProduct(wallNormal);
-        ball.Velocity.x -= 2 * dotProduct * wallNormal.x;
-        ball.Velocity.y -= 2 * dotProduct * wallNormal.y;
+        Bounce(ball, wallNormal, wall.material);
 
         // Calculate the closest point on the wall segment to the ball's position
         float projection = ballToWallStart.DotProduct(wallDir) / wallDir.DotProduct(wallDir);
@@ -180,57 +319,134 @@ private:
         ball.X += correction.x;
         ball.Y += correction.y;
 
-        // Reflect the ball's velocity
-        Vector normal = circleToBall.Normalize();
-        float dotProduct = ball.Velocity.x * normal.x + ball.Velocity.y * normal.y;
-        ball.Velocity.x -= 2 * dotProduct * normal.x;
-        ball.Velocity.y -= 2 * dotProduct * normal.y;
+        Bounce(ball, correction, circle.material);
     }
 
-    static bool IsCollidingSandTrap(Ball &ball, const SandTrap &sand)
+    // Separating axis test of the ball against a convex polygon. The edge the ball is
+    // furthest outside of is the only candidate for contact: either its face or one of its
+    // two vertices is the closest feature.
+    static void HandleCollisionPolygon(Ball &ball, const Polygon &polygon)
     {
-        Rect ballRect = GetBallHitbox(ball);
-        Rect sandRect = Rect(sand.x, sand.y, sand.width, sand.height);
-        return Arduboy2::collide(ballRect, sandRect);
-    }
+        // early out on the bounding circle
+        float dx = ball.X - polygon.center.x;
+        float dy = ball.Y - polygon.center.y;
+        float reach = polygon.radius + Ball::Radius;
+        if (dx * dx + dy * dy > reach * reach)
+            return;
+
+        uint8_t edge = 0;
+        float separation = -INFINITY;
+        for (uint8_t i = 0; i < polygon.vertexCount; i++)
+        {
+            float s = (polygon.normalX[i] * (ball.X - polygon.vertices[i].x) +
+                       polygon.normalY[i] * (ball.Y - polygon.vertices[i].y)) * (1.0f / 127);
+            if (s > separation)
+            {
+                separation = s;
+                edge = i;
+            }
+        }
 
-    static void HandleCollisionSandTrap(Ball &ball, const SandTrap &sand, float secondsDelta)
-    {
-        for (uint8_t i = 0; i < SandTrap::FrictionMultiplier; i++)
+        // separating axis found
+        if (separation > Ball::Radius)
+            return;
+
+        const Point8 &p1 = polygon.vertices[edge];
+        const Point8 &p2 = polygon.vertices[(edge + 1) % polygon.vertexCount];
+        Vector edgeDir = {p2.x - p1.x, p2.y - p1.y};
+        float t = ((ball.X - p1.x) * edgeDir.x + (ball.Y - p1.y) * edgeDir.y) / edgeDir.LengthSquared();
+
+        Vector normal;
+        float depth;
+        if (separation <= 0 || (t >= 0 && t <= 1))
         {
-            ball.ApplyFriction(secondsDelta);
+            // face contact, or the ball's center is already inside
+            normal = {polygon.normalX[edge] * (1.0f / 127), polygon.normalY[edge] * (1.0f / 127)};
+            depth = Ball::Radius - separation;
         }
+        else
+        {
+            // vertex contact
+            const Point8 &vertex = t < 0 ? p1 : p2;
+            Vector fromVertex = {ball.X - vertex.x, ball.Y - vertex.y};
+            float distance = fromVertex.Length();
+            if (distance > Ball::Radius || distance == 0)
+                return;
+
+            normal = fromVertex * (1 / distance);
+            depth = Ball::Radius - distance;
+        }
+
+        ball.X += normal.x * depth;
+        ball.Y += normal.y * depth;
+
+        if (ball.Velocity.DotProduct(normal) < 0)
+            Bounce(ball, normal, polygon.material);
     }
 
-    static bool IsCollidingTreadmill(Ball &ball, const Treadmill &treadmill)
+    // Swept test against one edge of a mover. Catches the ball crossing the edge within
+    // the step (a fast blade would otherwise pass through it) as well as plain contact,
+    // and bounces the ball in the edge's frame of reference.
+    static void HandleCollisionMovingSegment(Ball &ball, float fromX, float fromY, const Segment &before, const Segment &after, uint8_t material)
     {
-        Rect ballRect = GetBallHitbox(ball);
-        Rect teadRect = Rect(treadmill.x, treadmill.y, treadmill.width, treadmill.height);
-        return Arduboy2::collide(ballRect, teadRect);
+        Vector dir = {after.x2 - after.x1, after.y2 - after.y1};
+        float t = constrain(((ball.X - after.x1) * dir.x + (ball.Y - after.y1) * dir.y) / dir.LengthSquared(), 0.0, 1.0);
+        Vector closest = {after.x1 + t * dir.x, after.y1 + t * dir.y};
+        Vector away = {ball.X - closest.x, ball.Y - closest.y};
+        float distance = away.Length();
+
+        // which side of the edge the ball was on at the start and at the end of the step
+        float sideBefore = (before.x2 - before.x1) * (fromY - before.y1) - (before.y2 - before.y1) * (fromX - before.x1);
+        float sideAfter = dir.x * (ball.Y - after.y1) - dir.y * (ball.X - after.x1);
+        bool crossed = (sideBefore < 0) != (sideAfter < 0) && t > 0 && t < 1 && distance <= MaxStepApproach;
+
+        if (!crossed && distance > Ball::Radius)
+            return;
+
+        Vector normal;
+        if (crossed || distance == 0)
+        {
+            // push the ball back to the side it came from
+            normal = Vector{-dir.y, dir.x}.Normalize();
+            if (sideBefore < 0)
+                normal = normal * -1;
+        }
+        else
+        {
+            normal = away * (1 / distance);
+        }
+
+        ball.X = closest.x + normal.x * Ball::Radius;
+        ball.Y = closest.y + normal.y * Ball::Radius;
+
+        // velocity of the edge at the contact point
+        Vector surface = {(closest.x - (before.x1 + t * (before.x2 - before.x1))) / Ball::PhysicsStep,
+                          (closest.y - (before.y1 + t * (before.y2 - before.y1))) / Ball::PhysicsStep};
+
+        Vector relative = {ball.Velocity.x - surface.x, ball.Velocity.y - surface.y};
+        if (relative.DotProduct(normal) >= 0)
+            return; // already moving apart
+
+        ball.Velocity = relative;
+        Bounce(ball, normal, material);
+        ball.Velocity.x += surface.x;
+        ball.Velocity.y += surface.y;
     }
 
-    static void HandleCollisionTreadmill(Ball &ball, const Treadmill &treadmill, float secondsDelta)
+    // Reflects the ball's velocity off a surface with the given unit normal, scaled by the
+    // material's restitution
+    static void Bounce(Ball &ball, const Vector &normal, uint8_t materialIndex)
     {
-        auto velocityDelta = Treadmill::Speed * secondsDelta;
+        const Material &material = Materials::Get(materialIndex);
 
-        switch (treadmill.direction) {
-            case Direction::Up:
-                ball.Velocity.y -= velocityDelta;
-                break;
-            case Direction::Down:
-                ball.Velocity.y += velocityDelta;
-                break;
-            case Direction::Left:
-                ball.Velocity.x -= velocityDelta;
-                break;
-            case Direction::Right:
-                ball.Velocity.x += velocityDelta;
-                break;
+        if (material.flags & MaterialFlags::Sticky)
+        {
+            ball.Velocity = {0, 0};
+            return;
         }
-    }
 
-    static Rect GetBallHitbox(const Ball &ball)
-    {
-        return Rect(ball.X - 1, ball.Y - 1, 2, 2);
+        float dotProduct = ball.Velocity.DotProduct(normal) * (1 + material.restitution / 100.0f);
+        ball.Velocity.x -= dotProduct * normal.x;
+        ball.Velocity.y -= dotProduct * normal.y;
     }
 };
@@ -1,4 +1,23 @@
 #pragma once
 
-static constexpr uint8_t StartScreenNumOptions = 3;
-static constexpr uint8_t PauseScreenNumOptions = 2;
\ No newline at end of file
+static constexpr uint8_t StartScreenNumOptions = 6;
+static constexpr uint8_t StartScreenCourseOptionIdx = 3;
+static constexpr uint8_t StartScreenPlayersOptionIdx = 4;
+static constexpr uint8_t PauseScreenNumOptions = 2;
+
+static constexpr uint8_t FullFrameRate = 60;
+static constexpr uint8_t IdleFrameRate = 30; // used while nothing on screen needs smooth motion
+
+// Fast-forward while the ball is in motion: 2x, 4x, 8x, then "resolve instantly"
+static constexpr uint8_t NumFastForwardSpeeds = 4;
+static constexpr uint8_t InstantSpeed = 0;
+static constexpr uint8_t MaxPhysicsStepsPerFrame = 16;         // enough for 8x at the full frame rate
+static constexpr uint16_t InstantPhysicsMicrosPerFrame = 10000; // time budget for "resolve instantly"
+static constexpr uint16_t HoleGeneratorMicrosPerFrame = 4000;   // time budget for building an endless mode hole
+static constexpr uint8_t MapPreloadBytesPerFrame = 32;          // FX reads for staging the next hole, see MapManager::LoadMapStep
+
+// Hot-seat: players take turns, each with their own ball on the course
+static constexpr uint8_t MaxPlayers = 4;
+
+// Overview of the map explorer: the map at 1 / 2^shift of its size, from shift 1 (1/2) to this
+static constexpr uint8_t MaxOverviewShift = 2;
@@ -12,7 +12,7 @@ constexpr uint8_t CreditsSprite[] PROGMEM{
     0xF8, 0xF8, 0x58, 0xD8, 0xF8, 0xB0, 0x00, 0xF8, 0xF8, 0xD8, 0xD8, 0xD8, 0xD8, 0x00, 0xF0, 0xF8, 0x18, 0x18, 0xF8, 0xF8, 0x00, 0xF8, 0xF8, 0x18, 0xD8, 0xD8, 0xD0, 0x00, 0xF8, 0xF8, 0x00, 0x00, 0xF8, 0xF8, 0x00, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x00, 0xF0, 0xF8, 0x18, 0x18, 0xF8, 0xF8, 0x00, 0x18, 0x18, 0xF8, 0xF8, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x42, 0x21, 0x38, 0x40, 0x9C, 0xBE, 0x3E, 0xBC, 0xBD, 0xBC, 0x3E, 0xBE, 0x9C, 0x40, 0x38, 0x21, 0x42, 0x7C, 0x00,
     0x07, 0x07, 0x06, 0x06, 0x07, 0x03, 0x00, 0x03, 0x07, 0x06, 0x06, 0x06, 0x06, 0x00, 0x07, 0x07, 0x00, 0x00, 0x07, 0x07, 0x00, 0x03, 0x07, 0x06, 0x06, 0x07, 0x07, 0x00, 0x03, 0x07, 0x06, 0x06, 0x07, 0x07, 0x00, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x00, 0x07, 0x07, 0x00, 0x00, 0x07, 0x07, 0x00, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x06, 0x05, 0x04, 0x07, 0x00, 0x07, 0x04, 0x05, 0x06, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00};
 
-void PlayCreditsAnimation(Arduboy2Base arduboy)
+void PlayCreditsAnimation(Arduboy2Base &arduboy)
 {
     int16_t x = -CreditsSpriteWidth;
     int16_t y = 24;
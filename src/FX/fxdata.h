@@ -4,10 +4,13 @@
 
 using uint24_t = __uint24;
 
-// Initialize FX hardware using  FX::begin(FX_DATA_PAGE); in the setup() function.
+// Initialize FX hardware using  FX::begin(FX_DATA_PAGE, FX_SAVE_PAGE); in the setup() function.
 
-constexpr uint16_t FX_DATA_PAGE  = 0xffde;
-constexpr uint24_t FX_DATA_BYTES = 8512;
+constexpr uint16_t FX_DATA_PAGE  = 0xfda0;
+constexpr uint24_t FX_DATA_BYTES = 81737;
+
+constexpr uint16_t FX_SAVE_PAGE  = 0xfee0;
+constexpr uint24_t FX_SAVE_BYTES = 69633;
 
 constexpr uint24_t TreadmillUpSprite = 0x000000;
 constexpr uint16_t TreadmillUpSpriteWidth  = 8;
@@ -57,4 +60,55 @@ constexpr uint16_t InstructionsSpriteWidth  = 128;
 constexpr uint16_t InstructionsSpriteHeight = 64;
 constexpr uint8_t  InstructionsSpriteFrames = 4;
 
-constexpr uint24_t Maps = 0x001AC8;
+constexpr uint24_t MapSummaryPanel = 0x001AC8;
+constexpr uint16_t MapSummaryPanelWidth  = 92;
+constexpr uint16_t MapSummaryPanelHeight = 29;
+constexpr uint8_t  MapSummaryPanelFrames = 2;
+
+constexpr uint24_t MapCompletePanel = 0x00208C;
+constexpr uint16_t MapCompletePanelWidth  = 102;
+constexpr uint16_t MapCompletePanelHeight = 53;
+constexpr uint8_t  MapCompletePanelFrames = 2;
+
+constexpr uint24_t MapCompleteNoTotalPanel = 0x002BB8;
+constexpr uint16_t MapCompleteNoTotalPanelWidth  = 102;
+constexpr uint16_t MapCompleteNoTotalPanelHeight = 37;
+constexpr uint8_t  MapCompleteNoTotalPanelFrames = 2;
+
+constexpr uint24_t GameSummaryPanel = 0x0033B4;
+constexpr uint16_t GameSummaryPanelWidth  = 102;
+constexpr uint16_t GameSummaryPanelHeight = 53;
+constexpr uint8_t  GameSummaryPanelFrames = 2;
+
+constexpr uint24_t PauseMenuPanel = 0x003EE0;
+constexpr uint16_t PauseMenuPanelWidth  = 128;
+constexpr uint16_t PauseMenuPanelHeight = 64;
+constexpr uint8_t  PauseMenuPanelFrames = 2;
+
+constexpr uint24_t MapOverviewHalf = 0x0046E4;
+constexpr uint16_t MapOverviewHalfWidth  = 192;
+constexpr uint16_t MapOverviewHalfHeight = 128;
+constexpr uint8_t  MapOverviewHalfFrames = 13;
+
+constexpr uint24_t MapOverviewQuarter = 0x00E2E8;
+constexpr uint16_t MapOverviewQuarterWidth  = 96;
+constexpr uint16_t MapOverviewQuarterHeight = 64;
+constexpr uint8_t  MapOverviewQuarterFrames = 13;
+
+constexpr uint24_t MapThumbnail = 0x0109EC;
+constexpr uint16_t MapThumbnailWidth  = 32;
+constexpr uint16_t MapThumbnailHeight = 16;
+constexpr uint8_t  MapThumbnailFrames = 13;
+
+constexpr uint24_t MaterialTable = 0x010D30;
+constexpr uint24_t Maps = 0x010D72;
+constexpr uint24_t ObstacleChunks = 0x011C1F;
+constexpr uint24_t TerrainGrids = 0x011DDB;
+constexpr uint24_t ForceFieldIndex = 0x0137DB;
+constexpr uint24_t ForceFields = 0x0137E8;
+constexpr uint24_t CourseCount = 0x013BE8;
+constexpr uint24_t Courses = 0x013BE9;
+constexpr uint24_t CourseHoles = 0x013C29;
+constexpr uint24_t MapNames = 0x013C3D;
+constexpr uint24_t UIStringTable = 0x013D0D;
+constexpr uint24_t Font4x6Glyphs = 0x013DCD;
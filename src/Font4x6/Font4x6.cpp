@@ -6,479 +6,24 @@
  *  - added setCursorY method
  *  - added getCursorX method
  *  - added getCursorY method
+ *  - moved the glyph images to FX data (Font4x6Glyphs), indexed directly by ASCII code
+ *  - glyphs are blitted straight into the screen buffer instead of through Sprites
+ *  - added a batched write(buffer, size) so whole strings are drawn line by line
 */
 
 
 #include <Arduino.h>
-#include <Sprites.h>
+#include <Arduboy2.h>
 #include <Print.h>
 #include "Font4x6.h"
-
-#define USE_LOWER_CASE
+#include "../FX/ArduboyFX.h"
+#include "../FX/fxdata.h"
 
 #define FONT4x6_WIDTH 4
 #define FONT4x6_HEIGHT 7
 
-#define CHAR_EXCLAMATION 33
-#define CHAR_PERIOD 46
-#define CHAR_DOUBLEQUOTE 34
-#define CHAR_COLON 58
-#define CHAR_GREATERTHAN 62
-#define CHAR_LESSTHAN  60
-#define CHAR_PLUS  43
-#define CHAR_MINUS  45
-
-#define CHAR_LETTER_A 65
-#define CHAR_LETTER_Z 90
-#define CHAR_LETTER_A_LOWER 97
-#define CHAR_LETTER_Z_LOWER 122
-#define CHAR_NUMBER_0 48
-#define CHAR_NUMBER_9 57
-
-#ifdef USE_LOWER_CASE
-  #define FONT_EXCLAMATION_INDEX 62
-  #define FONT_PERIOD_INDEX 63
-  #define FONT_DOUBLEQUOTE_INDEX 64
-  #define FONT_COLON_INDEX 65
-  #define FONT_GREATERTHAN_INDEX 66
-  #define FONT_LESSTHAN_INDEX 67
-  #define FONT_PLUS_INDEX 68
-  #define FONT_MINUS_INDEX 69
-
-  #define FONT_NUMBER_INDEX 52
-#else
-  #define FONT_EXCLAMATION_INDEX 36
-  #define FONT_PERIOD_INDEX 37
-  #define FONT_NUMBER_INDEX 26
-#endif
-
-const uint8_t PROGMEM font_images[] = {
-  4, 8,
-
-  // #65 Letter 'A'.
-  0x3E,  // ░░▓▓▓▓▓░
-  0x09,  // ░░░░▓░░▓
-  0x09,  // ░░░░▓░░▓
-  0x3E,  // ░░▓▓▓▓▓░
-
-  // #66 Letter 'B'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x25,  // ░░▓░░▓░▓
-  0x25,  // ░░▓░░▓░▓
-  0x1A,  // ░░░▓▓░▓░
-
-  // #67 Letter 'C'.
-  0x1E,  // ░░░▓▓▓▓░
-  0x21,  // ░░▓░░░░▓
-  0x21,  // ░░▓░░░░▓
-  0x12,  // ░░░▓░░▓░
-
-  // #68 Letter 'D'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x21,  // ░░▓░░░░▓
-  0x21,  // ░░▓░░░░▓
-  0x1E,  // ░░░▓▓▓▓░
-
-  // #69 Letter 'E'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x25,  // ░░▓░░▓░▓
-  0x25,  // ░░▓░░▓░▓
-  0x21,  // ░░▓░░░░▓
-
-  // #70 Letter 'F'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x05,  // ░░░░░▓░▓
-  0x05,  // ░░░░░▓░▓
-  0x01,  // ░░░░░░░▓
-
-  // #71 Letter 'G'.
-  0x1E,  // ░░░▓▓▓▓░
-  0x21,  // ░░▓░░░░▓
-  0x29,  // ░░▓░▓░░▓
-  0x3A,  // ░░▓▓▓░▓░
-
-  // #72 Letter 'H'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x04,  // ░░░░░▓░░
-  0x04,  // ░░░░░▓░░
-  0x3F,  // ░░▓▓▓▓▓▓
-
-  // #73 Letter 'I'.
-  0x21,  // ░░▓░░░░▓
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x21,  // ░░▓░░░░▓
-  0x00,  // ░░░░░░░░
-
-  // #74 Letter 'J'.
-  0x10,  // ░░░▓░░░░
-  0x21,  // ░░▓░░░░▓
-  0x21,  // ░░▓░░░░▓
-  0x1F,  // ░░░▓▓▓▓▓
-
-  // #75 Letter 'K'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x04,  // ░░░░░▓░░
-  0x0A,  // ░░░░▓░▓░
-  0x31,  // ░░▓▓░░░▓
-
-  // #76 Letter 'L'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x20,  // ░░▓░░░░░
-  0x20,  // ░░▓░░░░░
-  0x20,  // ░░▓░░░░░
-
-  // #77 Letter 'M'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x02,  // ░░░░░░▓░
-  0x02,  // ░░░░░░▓░
-  0x3F,  // ░░▓▓▓▓▓▓
-
-  // #78 Letter 'N'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x02,  // ░░░░░░▓░
-  0x04,  // ░░░░░▓░░
-  0x3F,  // ░░▓▓▓▓▓▓
-
-  // #79 Letter 'O'.
-  0x1E,  // ░░░▓▓▓▓░
-  0x21,  // ░░▓░░░░▓
-  0x21,  // ░░▓░░░░▓
-  0x1E,  // ░░░▓▓▓▓░
-
-  // #80 Letter 'P'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x09,  // ░░░░▓░░▓
-  0x09,  // ░░░░▓░░▓
-  0x06,  // ░░░░░▓▓░
-
-  // #81 Letter 'Q'.
-  0x1E,  // ░░░▓▓▓▓░
-  0x21,  // ░░▓░░░░▓
-  0x11,  // ░░░▓░░░▓
-  0x2E,  // ░░▓░▓▓▓░
-
-  // #82 Letter 'R'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x09,  // ░░░░▓░░▓
-  0x09,  // ░░░░▓░░▓
-  0x36,  // ░░▓▓░▓▓░
-
-  // #83 Letter 'S'.
-  0x22,  // ░░▓░░░▓░
-  0x25,  // ░░▓░░▓░▓
-  0x25,  // ░░▓░░▓░▓
-  0x19,  // ░░░▓▓░░▓
-
-  // #84 Letter 'T'.
-  0x01,  // ░░░░░░░▓
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x01,  // ░░░░░░░▓
-  0x01,  // ░░░░░░░▓
-
-  // #85 Letter 'U'.
-  0x1F,  // ░░░▓▓▓▓▓
-  0x20,  // ░░▓░░░░░
-  0x20,  // ░░▓░░░░░
-  0x1F,  // ░░░▓▓▓▓▓
-
-  // #86 Letter 'V'.
-  0x0F,  // ░░░░▓▓▓▓
-  0x10,  // ░░░▓░░░░
-  0x20,  // ░░▓░░░░░
-  0x1F,  // ░░░▓▓▓▓▓
-
-  // #87 Letter 'W'.
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x10,  // ░░░▓░░░░
-  0x10,  // ░░░▓░░░░
-  0x3F,  // ░░▓▓▓▓▓▓
-
-  // #88 Letter 'X'.
-  0x3B,  // ░░▓▓▓░▓▓
-  0x04,  // ░░░░░▓░░
-  0x04,  // ░░░░░▓░░
-  0x3B,  // ░░▓▓▓░▓▓
-
-  // #89 Letter 'Y'.
-  0x03,  // ░░░░░░▓▓
-  0x04,  // ░░░░░▓░░
-  0x38,  // ░░▓▓▓░░░
-  0x07,  // ░░░░░▓▓▓
-
-  // #90 Letter 'Z'.
-  0x31,  // ░░▓▓░░░▓
-  0x2D,  // ░░▓░▓▓░▓
-  0x23,  // ░░▓░░░▓▓
-  0x21,  // ░░▓░░░░▓
-
-  #ifdef USE_LOWER_CASE
-
-    // #97 Letter 'a'.
-    0x10,  // ░░░▓░░░░
-    0x2A,  // ░░▓░▓░▓░
-    0x2A,  // ░░▓░▓░▓░
-    0x3C,  // ░░▓▓▓▓░░
-
-    // #98 Letter 'b'.
-    0x3F,  // ░░▓▓▓▓▓▓
-    0x24,  // ░░▓░░▓░░
-    0x24,  // ░░▓░░▓░░
-    0x18,  // ░░░▓▓░░░
-
-    // #99 Letter 'c'.
-    0x1C,  // ░░░▓▓▓░░
-    0x22,  // ░░▓░░░▓░
-    0x22,  // ░░▓░░░▓░
-    0x14,  // ░░░▓░▓░░
-
-    // #100 Letter 'd'.
-    0x18,  // ░░░▓▓░░░
-    0x24,  // ░░▓░░▓░░
-    0x24,  // ░░▓░░▓░░
-    0x3F,  // ░░▓▓▓▓▓▓
-
-    // #101 Letter 'e'.
-    0x1C,  // ░░░▓▓▓░░
-    0x2A,  // ░░▓░▓░▓░
-    0x2A,  // ░░▓░▓░▓░
-    0x2C,  // ░░▓░▓▓░░
-
-    // #102 Letter 'f'.
-    0x04,  // ░░░░░▓░░
-    0x7E,  // ░▓▓▓▓▓▓░
-    0x05,  // ░░░░░▓░▓
-    0x01,  // ░░░░░░░▓
-
-    // #103 Letter 'g'.
-    0x4C,  // ░▓░░▓▓░░
-    0x52,  // ░▓░▓░░▓░
-    0x52,  // ░▓░▓░░▓░
-    0x3E,  // ░░▓▓▓▓▓░
-
-    // #104 Letter 'h'.
-    0x3F,  // ░░▓▓▓▓▓▓
-    0x04,  // ░░░░░▓░░
-    0x04,  // ░░░░░▓░░
-    0x38,  // ░░▓▓▓░░░
-
-    // #105 Letter 'i'.
-    0x24,  // ░░▓░░▓░░
-    0x3D,  // ░░▓▓▓▓░▓
-    0x20,  // ░░▓░░░░░
-    0x00,  // ░░░░░░░░
-
-    // #106 Letter 'j'.
-    0x40,  // ░▓░░░░░░
-    0x40,  // ░▓░░░░░░
-    0x44,  // ░▓░░░▓░░
-    0x3D,  // ░░▓▓▓▓░▓
-
-    // #107 Letter 'k'.
-    0x3F,  // ░░▓▓▓▓▓▓
-    0x08,  // ░░░░▓░░░
-    0x14,  // ░░░▓░▓░░
-    0x22,  // ░░▓░░░▓░
-
-    // #108 Letter 'l'.
-    0x21,  // ░░▓░░░░▓
-    0x3F,  // ░░▓▓▓▓▓▓
-    0x20,  // ░░▓░░░░░
-    0x00,  // ░░░░░░░░
-
-    // #109 Letter 'm'.
-    0x3E,  // ░░▓▓▓▓▓░
-    0x04,  // ░░░░░▓░░
-    0x04,  // ░░░░░▓░░
-    0x3E,  // ░░▓▓▓▓▓░
-
-    // #110 Letter 'n'.
-    0x3E,  // ░░▓▓▓▓▓░
-    0x04,  // ░░░░░▓░░
-    0x02,  // ░░░░░░▓░
-    0x3C,  // ░░▓▓▓▓░░
-
-    // #111 Letter 'o'.
-    0x1C,  // ░░░▓▓▓░░
-    0x22,  // ░░▓░░░▓░
-    0x22,  // ░░▓░░░▓░
-    0x1C,  // ░░░▓▓▓░░
-
-    // #112 Letter 'p'.
-    0x7E,  // ░▓▓▓▓▓▓░
-    0x22,  // ░░▓░░░▓░
-    0x22,  // ░░▓░░░▓░
-    0x1C,  // ░░░▓▓▓░░
-
-    // #113 Letter 'q'.
-    0x1C,  // ░░░▓▓▓░░
-    0x22,  // ░░▓░░░▓░
-    0x22,  // ░░▓░░░▓░
-    0x7E,  // ░▓▓▓▓▓▓░
-
-    // #114 Letter 'r'.
-    0x3E,  // ░░▓▓▓▓▓░
-    0x04,  // ░░░░░▓░░
-    0x02,  // ░░░░░░▓░
-    0x04,  // ░░░░░▓░░
-
-    // #115 Letter 's'.
-    0x24,  // ░░▓░░▓░░
-    0x2A,  // ░░▓░▓░▓░
-    0x2A,  // ░░▓░▓░▓░
-    0x12,  // ░░░▓░░▓░
-
-    // #116 Letter 't'.
-    0x02,  // ░░░░░░▓░
-    0x1F,  // ░░░▓▓▓▓▓
-    0x22,  // ░░▓░░░▓░
-    0x20,  // ░░▓░░░░░
-
-    // #117 Letter 'u'.
-    0x1E,  // ░░░▓▓▓▓░
-    0x20,  // ░░▓░░░░░
-    0x20,  // ░░▓░░░░░
-    0x1E,  // ░░░▓▓▓▓░
-
-    // #118 Letter 'v'.
-    0x0E,  // ░░░░▓▓▓░
-    0x10,  // ░░░▓░░░░
-    0x20,  // ░░▓░░░░░
-    0x1E,  // ░░░▓▓▓▓░
-
-    // #119 Letter 'w'.
-    0x3E,  // ░░▓▓▓▓▓░
-    0x10,  // ░░░▓░░░░
-    0x10,  // ░░░▓░░░░
-    0x3E,  // ░░▓▓▓▓▓░
-
-    // #120 Letter 'x'.
-    0x36,  // ░░▓▓░▓▓░
-    0x08,  // ░░░░▓░░░
-    0x08,  // ░░░░▓░░░
-    0x36,  // ░░▓▓░▓▓░
-
-    // #121 Letter 'y'.
-    0x4E,  // ░▓░░▓▓▓░
-    0x50,  // ░▓░▓░░░░
-    0x50,  // ░▓░▓░░░░
-    0x3E,  // ░░▓▓▓▓▓░
-
-    // #122 Letter 'z'.
-    0x32,  // ░░▓▓░░▓░
-    0x2A,  // ░░▓░▓░▓░
-    0x26,  // ░░▓░░▓▓░
-    0x22,  // ░░▓░░░▓░
-
-  #endif
-
-  // #48 Number '0'.
-  0x1E,  // ░░░▓▓▓▓░
-  0x29,  // ░░▓░▓░░▓
-  0x25,  // ░░▓░░▓░▓
-  0x1E,  // ░░░▓▓▓▓░
-
-  // #49 Number '1'.
-  0x22,  // ░░▓░░░▓░
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x20,  // ░░▓░░░░░
-  0x00,  // ░░░░░░░░
-
-  // #50 Number '2'.
-  0x32,  // ░░▓▓░░▓░
-  0x29,  // ░░▓░▓░░▓
-  0x29,  // ░░▓░▓░░▓
-  0x26,  // ░░▓░░▓▓░
-
-  // #51 Number '3'.
-  0x12,  // ░░░▓░░▓░
-  0x21,  // ░░▓░░░░▓
-  0x25,  // ░░▓░░▓░▓
-  0x1A,  // ░░░▓▓░▓░
-
-  // #52 Number '4'.
-  0x0C,  // ░░░░▓▓░░
-  0x0A,  // ░░░░▓░▓░
-  0x3F,  // ░░▓▓▓▓▓▓
-  0x08,  // ░░░░▓░░░
-
-  // #53 Number '5'.
-  0x17,  // ░░░▓░▓▓▓
-  0x25,  // ░░▓░░▓░▓
-  0x25,  // ░░▓░░▓░▓
-  0x19,  // ░░░▓▓░░▓
-
-  // #54 Number '6'.
-  0x1E,  // ░░░▓▓▓▓░
-  0x25,  // ░░▓░░▓░▓
-  0x25,  // ░░▓░░▓░▓
-  0x18,  // ░░░▓▓░░░
-
-  // #55 Number '7'.
-  0x01,  // ░░░░░░░▓
-  0x39,  // ░░▓▓▓░░▓
-  0x05,  // ░░░░░▓░▓
-  0x03,  // ░░░░░░▓▓
-
-  // #56 Number '8'.
-  0x1A,  // ░░░▓▓░▓░
-  0x25,  // ░░▓░░▓░▓
-  0x25,  // ░░▓░░▓░▓
-  0x1A,  // ░░░▓▓░▓░
-
-  // #57 Number '9'.
-  0x06,  // ░░░░░▓▓░
-  0x29,  // ░░▓░▓░░▓
-  0x29,  // ░░▓░▓░░▓
-  0x1E,  // ░░░▓▓▓▓░
-
-  // #33 Symbol '!'.
-  0x00,  // ░░░░░░░░
-  0x2F,  // ░░▓░▓▓▓▓
-  0x00,  // ░░░░░░░░
-  0x00,  // ░░░░░░░░
-
-  // #46 Symbol '.'.
-  0x00,  // ░░░░░░░░
-  0x20,  // ░░▓░░░░░
-  0x00,  // ░░░░░░░░
-  0x00,  // ░░░░░░░░
-
-  // #34 Symbol '"'.
-  0x00,  // ░░░░░░░░
-  0x01,  // ░░░░░░░▓
-  0x00,  // ░░░░░░░░
-  0x01,  // ░░░░░░░▓
-
-  // #58 Symbol ':'.
-  0x00,  // ░░░░░░░░
-  0x24,  // ░░▓░░▓░░
-  0x00,  // ░░░░░░░░
-  0x00,  // ░░░░░░░░
-
-  // #62 Symbol '>'.
-  0x22,  // ░░▓░░░▓░
-  0x14,  // ░░░▓░▓░░
-  0x08,  // ░░░░▓░░░
-  0x00,  // ░░░░░░░░
-
-  // #60 Symbol '<'.
-  0x08,  // ░░░░▓░░░
-  0x14,  // ░░░▓░▓░░
-  0x22,  // ░░▓░░░▓░
-  0x00,  // ░░░░░░░░
-
-  // #43 Symbol '+'.
-  0x08,  // ░░░░▓░░░
-  0x1C,  // ░░░▓▓▓░░
-  0x08,  // ░░░░▓░░░
-  0x00,  // ░░░░░░░░
-
-  // #45 Symbol '-'.
-  0x08,  // ░░░░▓░░░
-  0x08,  // ░░░░▓░░░
-  0x08,  // ░░░░▓░░░
-  0x00,  // ░░░░░░░░
-};
+#define FONT_FIRST_CHAR 32  // ' '
+#define FONT_LAST_CHAR 126  // '~'
 
 
 Font4x6::Font4x6(uint8_t lineSpacing) {
@@ -493,80 +38,88 @@ Font4x6::Font4x6(uint8_t lineSpacing) {
 
 size_t Font4x6::write(uint8_t c) {
 
-  if (c == '\n')      { _cursorX = _baseX; _cursorY += _lineHeight; }
-  else {
+  return write(&c, 1);
 
-    printChar(c, _cursorX, _cursorY);
-    _cursorX += FONT4x6_WIDTH + _letterSpacing;
+}
+
+size_t Font4x6::write(const uint8_t *buffer, size_t size) {
+
+  const uint8_t *lineStart = buffer;
+  const uint8_t *end = buffer + size;
+
+  for (const uint8_t *p = buffer; p <= end; ++p) {
+
+    if (p == end || *p == '\n' || *p == '\r') {
+
+      if (p > lineStart) printLine(lineStart, p - lineStart);
+      if (p < end && *p == '\n') { _cursorX = _baseX; _cursorY += _lineHeight; }
+      lineStart = p + 1;
+
+    }
 
   }
 
-  return 1;
+  return size;
 
 }
 
-void Font4x6::printChar(const char c, const int8_t x, int8_t y) {
+void Font4x6::printLine(const uint8_t *text, uint8_t length) {
+
+  uint8_t columns[FONT4x6_WIDTH];
+
+  for (uint8_t i = 0; i < length; ++i) {
+
+    uint8_t c = text[i];
+
+    if (c > FONT_FIRST_CHAR && c <= FONT_LAST_CHAR && _cursorX > -FONT4x6_WIDTH && _cursorX < WIDTH) {
+
+      FX::readDataBytes(Font4x6Glyphs + (c - FONT_FIRST_CHAR) * FONT4x6_WIDTH, columns, FONT4x6_WIDTH);
+      drawGlyph(columns, _cursorX, _cursorY + 1);
+
+    }
+
+    _cursorX += FONT4x6_WIDTH + _letterSpacing;
 
-  int8_t idx = -1;
-
-  ++y;
-
-  switch (c) {
-    
-    case CHAR_LETTER_A ... CHAR_LETTER_Z:
-      idx = c - CHAR_LETTER_A;
-      break;
-
-#ifdef USE_LOWER_CASE    
-    case CHAR_LETTER_A_LOWER ... CHAR_LETTER_Z_LOWER:
-      idx = c - CHAR_LETTER_A_LOWER + 26;
-      break;
-#endif
-
-    case CHAR_NUMBER_0 ... CHAR_NUMBER_9:
-      idx = c - CHAR_NUMBER_0 + FONT_NUMBER_INDEX;
-      break;
-      
-    case CHAR_EXCLAMATION:
-      idx = FONT_EXCLAMATION_INDEX;
-      break;
-      
-    case CHAR_PERIOD:
-      idx = FONT_PERIOD_INDEX;
-      break;
-
-    case CHAR_DOUBLEQUOTE:
-      idx = FONT_DOUBLEQUOTE_INDEX;
-      break;
-
-    case CHAR_COLON:
-      idx = FONT_COLON_INDEX;
-      break;
-
-    case CHAR_GREATERTHAN:
-      idx = FONT_GREATERTHAN_INDEX;
-      break;
-
-    case CHAR_LESSTHAN:
-      idx = FONT_LESSTHAN_INDEX;
-      break;
-
-    case CHAR_PLUS:
-      idx = FONT_PLUS_INDEX;
-      break;
-
-    case CHAR_MINUS:
-      idx = FONT_MINUS_INDEX;
-      break;
   }
 
-  if (idx > -1) {
-    
+}
+
+void Font4x6::printChar(const char c, const int8_t x, int8_t y) {
+
+  int8_t cursorX = _cursorX;
+  int8_t cursorY = _cursorY;
+
+  _cursorX = x;
+  _cursorY = y;
+  printLine(reinterpret_cast<const uint8_t *>(&c), 1);
+
+  _cursorX = cursorX;
+  _cursorY = cursorY;
+
+}
+
+void Font4x6::drawGlyph(const uint8_t *columns, int16_t x, int16_t y) {
+
+  if (y <= -8 || y >= HEIGHT) return;
+
+  int8_t page = y >> 3;
+  uint8_t shift = y & 7;
+
+  for (uint8_t i = 0; i < FONT4x6_WIDTH; ++i, ++x) {
+
+    if (x < 0 || x >= WIDTH) continue;
+
+    uint8_t *column = Arduboy2Base::sBuffer + x + page * WIDTH;
+    uint8_t top = columns[i] << shift;
+    uint8_t bottom = shift ? columns[i] >> (8 - shift) : 0;
+
     if (_textColor == WHITE) {
-      Sprites::drawSelfMasked(x, y, font_images, idx);
+      if (page >= 0) column[0] |= top;
+      if (page < (HEIGHT / 8) - 1) column[WIDTH] |= bottom;
     }
     else {
-      Sprites::drawErase(x, y, font_images, idx);
+      if (page >= 0) column[0] &= ~top;
+      if (page < (HEIGHT / 8) - 1) column[WIDTH] &= ~bottom;
     }
 
   }
@@ -6,6 +6,9 @@
  *  - added setCursorY method
  *  - added getCursorX method
  *  - added getCursorY method
+ *  - moved the glyph images to FX data (Font4x6Glyphs), indexed directly by ASCII code
+ *  - glyphs are blitted straight into the screen buffer instead of through Sprites
+ *  - added a batched write(buffer, size) so whole strings are drawn line by line
 */
 
 
@@ -20,8 +23,11 @@ class Font4x6 : public Print {
 
     Font4x6(uint8_t lineSpacing = 8);   
 
+    using Print::write;
     virtual size_t write(uint8_t); // used by the Arduino Print class
+    virtual size_t write(const uint8_t *buffer, size_t size); // used by print(String) and print(const char*)
     void printChar(const char c, const int8_t x, int8_t y);
+    void printLine(const uint8_t *text, uint8_t length); // prints text without line breaks at the cursor
 
     void setCursor(const int8_t x, const int8_t y);
     void setCursorX(const int8_t x);
@@ -45,4 +51,6 @@ class Font4x6 : public Print {
     uint8_t _letterSpacing;  // letterSpacing controls the distance between letters. Default is 1.
     uint8_t _lineHeight;     // lineHeight controls the height between lines breakend by \n. Default is 8.
 
+    void drawGlyph(const uint8_t *columns, int16_t x, int16_t y);
+
 };
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Ball.h"
+#include "FX/ArduboyFX.h"
+#include "FX/fxdata.h"
+#include "Map.h"
+#include <Arduboy2.h>
+
+namespace ForceFieldFlags
+{
+    constexpr uint8_t Bilinear = 1 << 4; // blend the four nearest cells, for smooth slopes
+    constexpr uint8_t Gusty = 1 << 5;    // strength rises and falls with the mover clock, for wind
+}
+
+// Continuous forces over a map, such as slopes and wind. Stored in FX data as a grid of
+// 16x16 pixel cells holding an int8_t (x, y) acceleration in pixels per second squared.
+// Only the maps with an entry in ForceFieldIndex have one.
+//
+// Like Terrain, an instance caches the cells the ball was last looked up in, so a step
+// costs an FX read only when the ball moves into another cell.
+class ForceField
+{
+public:
+    static constexpr uint8_t CellShift = 4;
+    static constexpr uint8_t CellSize = 1 << CellShift;
+    static constexpr uint8_t GridColumns = 16; // 16 * CellSize covers the largest possible map (255 pixels)
+    static constexpr uint8_t GridRows = 16;
+    static constexpr uint8_t RowBytes = GridColumns * 2;
+    static constexpr uint16_t GridBytes = RowBytes * GridRows;
+    static constexpr uint8_t GustPeriodShift = 9; // a gust rises and falls over 2^9 Ball::PhysicsSteps
+
+    // Sets the map's field address and flags from ForceFieldIndex
+    static void LoadMapField(Map &map, uint8_t mapIndex)
+    {
+        uint8_t entry;
+        FX::readDataBytes(ForceFieldIndex + mapIndex, &entry, 1);
+
+        uint8_t slot = entry & 0x0F;
+        map.forces = slot == 0 ? 0 : ForceFields + static_cast<uint24_t>(slot - 1) * GridBytes;
+        map.forceFlags = entry & 0xF0;
+    }
+
+    // Reads `count` cells of a row, starting at the given column, as (x, y) pairs
+    static void ReadRow(uint24_t grid, uint8_t row, uint8_t column, int8_t *forces, uint8_t count)
+    {
+        FX::readDataBytes(grid + row * RowBytes + column * 2, reinterpret_cast<uint8_t *>(forces), count * 2);
+    }
+
+    // Adds the field's acceleration over one Ball::PhysicsStep to the ball's velocity.
+    // Returns false if there is no force where the ball is.
+    bool Apply(const Map &map, Ball &ball, uint16_t tick)
+    {
+        if (map.forces == 0)
+            return false;
+
+        float forceX, forceY;
+        if (map.forceFlags & ForceFieldFlags::Bilinear)
+            SampleBilinear(map, ball.X, ball.Y, forceX, forceY);
+        else
+            SampleNearest(map, ball.X, ball.Y, forceX, forceY);
+
+        if (forceX == 0 && forceY == 0)
+            return false;
+
+        float scale = Ball::PhysicsStep;
+        if (map.forceFlags & ForceFieldFlags::Gusty)
+            scale *= GetGust(tick);
+
+        ball.Velocity.x += forceX * scale;
+        ball.Velocity.y += forceY * scale;
+        return true;
+    }
+
+private:
+    static constexpr uint16_t NoCell = UINT16_MAX;
+
+    uint16_t _cell = NoCell; // top left of the cached cells
+    int8_t _forces[2][4];    // rows of two cells, (x, y) each
+
+    void SampleNearest(const Map &map, float x, float y, float &forceX, float &forceY)
+    {
+        forceX = forceY = 0;
+        if (x < 0 || y < 0 || x >= GridColumns * CellSize || y >= GridRows * CellSize)
+            return;
+
+        uint8_t column = static_cast<uint8_t>(x) >> CellShift;
+        uint8_t row = static_cast<uint8_t>(y) >> CellShift;
+        uint16_t cell = row * GridColumns + column;
+
+        if (cell != _cell)
+        {
+            ReadRow(map.forces, row, column, _forces[0], 1);
+            _cell = cell;
+        }
+
+        forceX = _forces[0][0];
+        forceY = _forces[0][1];
+    }
+
+    // Blends the four cells whose centers surround the position
+    void SampleBilinear(const Map &map, float x, float y, float &forceX, float &forceY)
+    {
+        forceX = forceY = 0;
+
+        // position relative to the center of the top left cell
+        float gridX = constrain(x / CellSize - 0.5f, 0, GridColumns - 1.001f);
+        float gridY = constrain(y / CellSize - 0.5f, 0, GridRows - 1.001f);
+        uint8_t column = static_cast<uint8_t>(gridX);
+        uint8_t row = static_cast<uint8_t>(gridY);
+        uint16_t cell = row * GridColumns + column;
+
+        if (cell != _cell)
+        {
+            ReadRow(map.forces, row, column, _forces[0], 2);
+            ReadRow(map.forces, row + 1, column, _forces[1], 2);
+            _cell = cell;
+        }
+
+        float fractionX = gridX - column;
+        float fractionY = gridY - row;
+
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            float weightY = i == 0 ? 1 - fractionY : fractionY;
+            forceX += weightY * (_forces[i][0] * (1 - fractionX) + _forces[i][2] * fractionX);
+            forceY += weightY * (_forces[i][1] * (1 - fractionX) + _forces[i][3] * fractionX);
+        }
+    }
+
+    // 0 to 1 and back over a gust period
+    static float GetGust(uint16_t tick)
+    {
+        uint16_t cycle = tick << (16 - GustPeriodShift);
+        return (cycle < 0x8000 ? cycle : 0x10000 - cycle) * (1.0f / 0x8000);
+    }
+};
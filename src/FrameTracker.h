@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Constants.h"
+#include <Arduboy2.h>
+
+// Everything that affects what ends up on screen. If two consecutive frames
+// produce the same FrameState, the second frame would draw identical pixels.
+struct FrameState
+{
+    uint8_t gameState;
+    uint8_t courseIdx;
+    uint8_t mapIndex;
+    bool generatingHole;
+    bool minimap;
+    uint8_t strokes;
+    uint8_t numPlayers;
+    uint8_t player;
+    uint8_t menuIdx; // selected option/hole/page of the current menu
+    uint8_t playbackSpeed;
+    int16_t cameraX;
+    int16_t cameraY;
+    int16_t ballX[MaxPlayers];
+    int16_t ballY[MaxPlayers];
+    int16_t ghostX;
+    int16_t ghostY;
+    float ballDirection;
+    float ballPower;
+    uint16_t animationState;
+    uint16_t moverTick;
+};
+
+class FrameTracker
+{
+private:
+    FrameState _lastState;
+    bool _forceRedraw = true;
+
+public:
+    // Returns true if the state differs from the last frame that was drawn
+    bool HasChanged(const FrameState &state)
+    {
+        if (!_forceRedraw && memcmp(&state, &_lastState, sizeof(FrameState)) == 0)
+            return false;
+
+        _lastState = state;
+        _forceRedraw = false;
+        return true;
+    }
+
+    // Makes the next call to HasChanged() return true
+    void Invalidate()
+    {
+        _forceRedraw = true;
+    }
+};
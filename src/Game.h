@@ -2,10 +2,16 @@
 
 #include "Ball.h"
 #include "Camera.h"
+#include "ChunkCache.h"
 #include "CollisionHandler.h"
 #include "Constants.h"
+#include "ForceField.h"
+#include "FrameTracker.h"
+#include "Ghost.h"
+#include "HoleGenerator.h"
 #include "Map.h"
 #include "MapManager.h"
+#include "Terrain.h"
 #include <Arduboy2.h>
 
 enum class GameState
@@ -17,56 +23,131 @@ enum class GameState
     Aiming,
     ChoosingPower,
     MapExplorer,
+    MapOverview,
     PauseMenu,
     BallInMotion,
     MapComplete,
     GameSummary,
 };
 
+constexpr uint8_t NumGameStates = static_cast<uint8_t>(GameState::GameSummary) + 1;
+
+// Properties of a GameState, see GameStateInfo
+namespace GameStateFlags
+{
+    constexpr uint8_t Pausable = 1 << 0;      // holding B opens the pause menu
+    constexpr uint8_t PhysicsActive = 1 << 1; // balls are simulated, which also drives the movers
+    constexpr uint8_t NeedsMap = 1 << 2;      // the course is drawn, and its movers run, under the state's UI
+    constexpr uint8_t FullFrameRate = 1 << 3; // never drops to IdleFrameRate
+    constexpr uint8_t FreeCamera = 1 << 4;    // the camera doesn't follow the ball
+    constexpr uint8_t Background = 1 << 5;    // draws a full-screen background prefetched from FX
+    constexpr uint8_t Minimap = 1 << 6;       // shows the minimap when the player turned it on
+}
+
+class Game;
+
+// Everything Game does differently per state, so adding a state means adding an entry
+// to Game's state table rather than a case to every switch. Kept in PROGMEM.
+struct GameStateInfo
+{
+    void (Game::*handleInput)();
+    void (Game::*tick)();    // extra work done every frame, may be nullptr
+    void (Game::*display)(); // drawn on top of the course if the state NeedsMap
+    uint8_t Game::*menuIdx;  // highlighted option, may be nullptr
+    uint8_t animationLayers; // AnimationLayer flags visible in the state
+    uint8_t flags;           // GameStateFlags
+};
+
 class Game
 {
 private:
-    Arduboy2Base _arduboy;
-    uint8_t _mapIndex;
+    Arduboy2Base &_arduboy; // the sketch's, shared with the Camera
+    uint8_t _courseIdx = 0;
+    Course _course;
+    uint8_t _holeIdx;  // hole of the course being played
+    uint8_t _mapIndex; // its index into the Maps in FX data
     Map _map;
+    ChunkCache _chunks; // obstacles of a chunked _map around the camera
+    // the next hole is staged into _map while the hole complete screen shows, see TickMapComplete()
+    bool _preloading;
+    bool _preloaded;
+    uint8_t _preloadProgress;
+    uint8_t _completedPar; // par of the hole on the hole complete screen
     Camera _camera;
-    Ball _ball;
+    // per-player state, indexed by player
+    uint8_t _numPlayers = 1;
+    uint8_t _player; // whose turn it is
+    Ball _balls[MaxPlayers];
+    Terrain _terrains[MaxPlayers]; // floor cache of each ball
+    ForceField _forceFields[MaxPlayers]; // slope and wind cache of each ball
+    uint8_t _contactFreeSteps[MaxPlayers]; // upcoming physics steps in which the ball can't touch anything
+    uint8_t _strokes[MaxPlayers][MapManager::MaxCourseHoles] = {{0}};
+    int8_t _totalOverUnder[MaxPlayers] = {0};
+    uint8_t _movingBalls;   // bit per player: balls rolling in the current shot
+    uint8_t _onCourseBalls; // bit per player: balls that have left the tee on this hole
+    uint8_t _holedBalls;    // bit per player: balls that are in the hole
+    GhostPlayer _ghost;             // personal-best round of the hole, single player only
+    GhostRecorder _ghostRecorder;
     GameState _gameState = GameState::StartScreen;
     GameState _gameStateBeforePause = GameState::StartScreen;
     uint8_t _totalPar;
-    uint8_t _strokes[MapManager::NumMaps] = {0};
-    int8_t _totalOverUnder = 0;
     float _secondsDelta;
-    bool _doubleSpeedEnabled;
+    bool _fastForwardEnabled;
+    uint8_t _fastForwardSpeedIdx = 0;
+    float _physicsSeconds; // simulated time owed to the ball, consumed in Ball::PhysicsStep steps
+    bool _hasMovers;
+    uint16_t _moverTick = 0;   // clock of the moving obstacles, in Ball::PhysicsSteps
+    float _moverSeconds = 0;   // time not yet turned into mover ticks while the ball is at rest
     uint8_t _startScreenOptionIdx;
     uint8_t _holeSelectionIdx;
     bool _singleHoleMode;
+    bool _endlessMode;           // holes are generated, see HoleGenerator
+    uint8_t _endlessHoleNum;
+    HoleGenerator _holeGenerator;
     uint8_t _instructionsPageIdx;
     float _pauseButtonHeldSeconds;
     bool _BButtonPressStartedDuringAim;
     uint8_t _pauseOptionIdx;
+    uint8_t _overviewShift; // scale of the map overview, see MaxOverviewShift
+    bool _minimapEnabled = false; // toggled with Up while aiming
+    FrameTracker _frameTracker;
+    uint8_t _frameRate = FullFrameRate;
 
     const static float _pauseButtonHoldPauseTime = 0.5;
 
+    static const GameStateInfo _stateTable[NumGameStates];
+
 public:
-    Game(Arduboy2Base arduboy) : _arduboy(arduboy)
+    Game(Arduboy2Base &arduboy) : _arduboy(arduboy), _camera(arduboy)
     {
     }
 
-    void Init(uint8_t mapIndex = 0)
+    void Init(uint8_t holeIdx = 0)
     {
-        _mapIndex = mapIndex;
+        _course = MapManager::LoadCourse(_courseIdx);
+        _holeIdx = holeIdx;
+        _mapIndex = MapManager::GetMapIndex(_course, _holeIdx);
         _map = MapManager::LoadMap(_mapIndex);
-        _camera = Camera(_arduboy, 0, 0, _map.width, _map.height);
-        _ball = Ball(static_cast<float>(_map.start.x), static_cast<float>(_map.start.y));
+        _camera.Reset(_map.start.x, _map.start.y, _map.width, _map.height);
+        _chunks.Reset();
+        ResetBalls();
+        _hasMovers = HasMovers();
         _secondsDelta = 0;
-        _doubleSpeedEnabled = false;
-        _totalPar = MapManager::GetTotalPar();
+        _fastForwardEnabled = false;
+        _physicsSeconds = 0;
+        _totalPar = _course.totalPar;
         _pauseOptionIdx = 0;
-        _totalOverUnder = 0;
+        _endlessMode = false;
+        _preloading = false;
+        _preloaded = false;
+        _ghost.Hide(); // a round quit from the pause menu mustn't haunt the next summary
 
-        for (uint8_t i = 0; i < MapManager::NumMaps; i++)
-            _strokes[i] = 0;
+        for (uint8_t p = 0; p < MaxPlayers; p++)
+        {
+            _totalOverUnder[p] = 0;
+            for (uint8_t i = 0; i < MapManager::MaxCourseHoles; i++)
+                _strokes[p][i] = 0;
+        }
     }
 
     void Tick(float secondsDelta)
@@ -75,95 +156,96 @@ public:
 
         HandleInput();
 
-        if (_gameState == GameState::ChoosingPower)
-        {
-            _ball.TickPower(secondsDelta);
-        }
+        GameStateInfo info = GetStateInfo();
+        if (info.tick != nullptr)
+            (this->*info.tick)();
 
-        if (_gameState == GameState::BallInMotion)
-        {
+        if (info.flags & GameStateFlags::PhysicsActive)
             TickBallInMotion();
+        else if (info.flags & GameStateFlags::NeedsMap)
+            TickMovers();
+
+        if (!(info.flags & GameStateFlags::FreeCamera))
+            _camera.Follow(FocusBall(), FullFrameRate / _frameRate);
+
+        if ((info.flags & GameStateFlags::NeedsMap) && _holeGenerator.IsDone() && !_preloading)
+            UpdateChunks(info.flags & GameStateFlags::FreeCamera);
+
+        _camera.TickAnimations(FullFrameRate / _frameRate);
+        UpdateFrameRate();
+    }
 
-            // move ball twice per tick if in 2x speed
-            if (_doubleSpeedEnabled)
-                TickBallInMotion();
+    // Returns false when the next Display() would draw the same pixels as the last one,
+    // in which case the display can keep showing the previous frame
+    bool NeedsRedraw()
+    {
+        FrameState state;
+        state.gameState = static_cast<uint8_t>(_gameState);
+        state.courseIdx = _courseIdx;
+        state.mapIndex = _mapIndex;
+        state.generatingHole = !_holeGenerator.IsDone();
+        state.minimap = ShowsMinimap();
+        state.strokes = _strokes[_player][_holeIdx];
+        state.numPlayers = _numPlayers;
+        state.player = _player;
+        state.menuIdx = GetMenuIdx();
+        state.playbackSpeed = GetPlaybackSpeed();
+        state.cameraX = _camera.GetX();
+        state.cameraY = _camera.GetY();
+        for (uint8_t i = 0; i < MaxPlayers; i++)
+        {
+            state.ballX[i] = static_cast<int16_t>(_balls[i].X);
+            state.ballY[i] = static_cast<int16_t>(_balls[i].Y);
         }
+        state.ghostX = _ghost.IsVisible() ? _ghost.GetX() : 0;
+        state.ghostY = _ghost.IsVisible() ? _ghost.GetY() : 0;
+        state.ballDirection = CurrentBall().Direction;
+        state.ballPower = CurrentBall().Power;
+        state.animationState = _camera.GetAnimationState(GetAnimationLayers());
+        state.moverTick = _hasMovers && (GetAnimationLayers() & AnimationLayer::Map) ? _moverTick : 0;
 
-        if (_gameState != GameState::MapExplorer)
-            _camera.FocusOn(_ball.X, _ball.Y);
+        return _frameTracker.HasChanged(state);
     }
 
     void Display()
     {
-        switch (_gameState)
+        GameStateInfo info = GetStateInfo();
+
+        if (!(info.flags & GameStateFlags::Background))
+            _camera.DiscardPrefetchedBackground();
+
+        // while the next hole is loading, the old one stays on screen from the held frame
+        if (!_preloading)
+            _camera.DiscardHeldFrame();
+
+        bool minimap = ShowsMinimap();
+        if (minimap)
+            _camera.PlaceMinimap(CurrentBall());
+
+        if ((info.flags & GameStateFlags::NeedsMap) && _holeGenerator.IsDone() && !_preloading)
         {
-            case GameState::StartScreen:
-                _camera.DrawStartScreen(_startScreenOptionIdx);
-                break;
-            case GameState::HoleSelection:
-                _camera.DrawHoleSelection(_holeSelectionIdx);
-                break;
-            case GameState::Instructions:
-                _camera.DrawInstructions(_instructionsPageIdx);
-                break;
-            case GameState::MapSummary:
-                _camera.DrawMap(_map);
-                _camera.DrawHole(_map.end.x, _map.end.y, !IsBallNearHole());
-                _camera.DrawBall(_ball);
-                _camera.DrawMapSummary(_mapIndex + 1, _map);
-                break;
-            case GameState::Aiming:
-                _camera.DrawMap(_map);
-                _camera.DrawHole(_map.end.x, _map.end.y, !IsBallNearHole());
-                _camera.DrawBall(_ball);
-                _camera.DrawAimHud(_ball);
-                break;
-            case GameState::ChoosingPower:
-                _camera.DrawMap(_map);
-                _camera.DrawHole(_map.end.x, _map.end.y, !IsBallNearHole());
-                _camera.DrawBall(_ball);
-                _camera.DrawAimHud(_ball);
-                break;
-            case GameState::MapExplorer:
-                _camera.DrawMap(_map);
-                _camera.DrawHole(_map.end.x, _map.end.y, !IsBallNearHole());
-                _camera.DrawBall(_ball);
-                _camera.DrawAimHud(_ball);
-                _camera.DrawMapExplorerIndicator();
-                break;
-            case GameState::PauseMenu:
-                _camera.DrawPauseMenu(_mapIndex + 1, _map, _strokes[_mapIndex], _pauseOptionIdx);
-                break;
-            case GameState::BallInMotion:
-                _camera.DrawMap(_map);
-                _camera.DrawHole(_map.end.x, _map.end.y, !IsBallNearHole());
-                _camera.DrawBall(_ball);
-                if (_doubleSpeedEnabled)
-                    _camera.DrawDoubleSpeedIndicator();
-                break;
-            case GameState::MapComplete:
-                _camera.DrawMap(_map);
-                _camera.DrawHole(_map.end.x, _map.end.y, !IsBallNearHole());
-                _camera.DrawBall(_ball);
-                if (_singleHoleMode)
-                    _camera.DrawMapCompleteNoTotal(_mapIndex + 1, _map, _strokes[_mapIndex]);
-                else
-                    _camera.DrawMapComplete(_mapIndex + 1, _map, _strokes[_mapIndex], _totalOverUnder);
-                break;
-            case GameState::GameSummary:
-                uint16_t totalStrokes = 0;
-                for (uint8_t i = 0; i < MapManager::NumMaps; i++)
-                    totalStrokes += _strokes[i];
-                _camera.DrawGameSummary(totalStrokes, _totalPar);
-                break;
+            _camera.DrawMap(_map, _moverTick, minimap);
+            _camera.DrawHole(_map.end.x, _map.end.y, !IsBallNearHole());
+            DrawGhost();
+            DrawBalls();
         }
+
+        if (minimap)
+            _camera.DrawMinimap(_mapIndex, _map, CurrentBall());
+
+        (this->*info.display)();
+    }
+
+    void PresentFrame()
+    {
+        _camera.PresentFrame();
     }
 
 private:
     void HandleInput()
     {
         // check for pauses
-        if (InPausableMode())
+        if (GetStateInfo().flags & GameStateFlags::Pausable)
         {
             if (_arduboy.pressed(B_BUTTON))
             {
@@ -179,42 +261,8 @@ private:
                 _pauseButtonHeldSeconds = 0;
         }
 
-        switch (_gameState)
-        {
-            case GameState::StartScreen:
-                HandleInputStartScreen();
-                break;
-            case GameState::HoleSelection:
-                HandleInputHoleSelection();
-                break;
-            case GameState::Instructions:
-                HandleInputInstructions();
-                break;
-            case GameState::MapSummary:
-                HandleInputMapSummary();
-                break;
-            case GameState::Aiming:
-                HandleInputAiming();
-                break;
-            case GameState::ChoosingPower:
-                HandleInputChoosingPower();
-                break;
-            case GameState::MapExplorer:
-                HandleInputMapExplorer();
-                break;
-            case GameState::PauseMenu:
-                HandleInputPauseMenu();
-                break;
-            case GameState::BallInMotion:
-                HandleInputBallInMotion();
-                break;
-            case GameState::MapComplete:
-                HandleInputMapComplete();
-                break;
-            case GameState::GameSummary:
-                HandleInputGameSummary();
-                break;
-        }
+        // looked up again, pausing takes effect this frame
+        (this->*GetStateInfo().handleInput)();
     }
 
     void HandleInputStartScreen()
@@ -238,12 +286,55 @@ private:
                     _gameState = GameState::HoleSelection;
                     break;
 
-                // Instructions
+                // Endless generated holes
                 case (2):
+                    Init();
+                    _endlessMode = true;
+                    _endlessHoleNum = 0;
+                    BeginGeneratedHole(static_cast<uint16_t>(micros()));
+                    break;
+
+                // Course to play
+                case (StartScreenCourseOptionIdx):
+                    SelectCourse(1);
+                    break;
+
+                // Number of players
+                case (StartScreenPlayersOptionIdx):
+                    _numPlayers = _numPlayers % MaxPlayers + 1;
+                    break;
+
+                // Instructions
+                case (5):
                     _gameState = GameState::Instructions;
                     break;
             }
         }
+
+        if (_startScreenOptionIdx == StartScreenCourseOptionIdx)
+        {
+            if (_arduboy.justPressed(LEFT_BUTTON))
+                SelectCourse(-1);
+            if (_arduboy.justPressed(RIGHT_BUTTON))
+                SelectCourse(1);
+        }
+
+        if (_startScreenOptionIdx == StartScreenPlayersOptionIdx)
+        {
+            if (_arduboy.justPressed(LEFT_BUTTON))
+                _numPlayers = max(1, _numPlayers - 1);
+            if (_arduboy.justPressed(RIGHT_BUTTON))
+                _numPlayers = min(_numPlayers + 1, MaxPlayers);
+        }
+    }
+
+    // Steps through the course directory, wrapping around at either end
+    void SelectCourse(int8_t step)
+    {
+        uint8_t numCourses = MapManager::GetNumCourses();
+        _courseIdx = (_courseIdx + numCourses + step) % numCourses;
+        _course = MapManager::LoadCourse(_courseIdx);
+        _holeSelectionIdx = 0;
     }
 
     void HandleInputHoleSelection()
@@ -251,7 +342,11 @@ private:
         if (_arduboy.justPressed(UP_BUTTON))
             _holeSelectionIdx = max(0, _holeSelectionIdx - 1);
         if (_arduboy.justPressed(DOWN_BUTTON))
-            _holeSelectionIdx = min(_holeSelectionIdx + 1, MapManager::NumMaps - 1);
+            _holeSelectionIdx = min(_holeSelectionIdx + 1, _course.numHoles - 1);
+        if (_arduboy.justPressed(LEFT_BUTTON))
+            SelectCourse(-1);
+        if (_arduboy.justPressed(RIGHT_BUTTON))
+            SelectCourse(1);
         if (_arduboy.justPressed(A_BUTTON))
         {
             _singleHoleMode = true;
@@ -284,9 +379,13 @@ private:
 
     void HandleInputMapSummary()
     {
-        if (AnyButtonPressed(_arduboy)) {
+        if (!_holeGenerator.IsDone())
+            return;
+
+        if (AnyButtonPressed()) {
             _gameState = GameState::Aiming;
             _BButtonPressStartedDuringAim = false;
+            BeginGhost();
         }
     }
 
@@ -295,9 +394,11 @@ private:
         if (_arduboy.justPressed(A_BUTTON))
             _gameState = GameState::ChoosingPower;
         if (_arduboy.pressed(LEFT_BUTTON))
-            _ball.RotateDirectionCounterClockwise(_secondsDelta);
+            CurrentBall().RotateDirectionCounterClockwise(_secondsDelta);
         if (_arduboy.pressed(RIGHT_BUTTON))
-            _ball.RotateDirectionClockwise(_secondsDelta);
+            CurrentBall().RotateDirectionClockwise(_secondsDelta);
+        if (_arduboy.justPressed(UP_BUTTON))
+            _minimapEnabled = !_minimapEnabled;
 
         
         if (_arduboy.justPressed(B_BUTTON))
@@ -318,27 +419,52 @@ private:
         if (_arduboy.justPressed(A_BUTTON))
         {
             _gameState = GameState::BallInMotion;
-            _ball.StartHit();
-            _strokes[_mapIndex]++;
+            if (UsesGhost())
+            {
+                _ghostRecorder.StartStroke(CurrentBall());
+                _ghost.Play();
+            }
+            CurrentBall().StartHit();
+            _strokes[_player][_holeIdx]++;
+            _movingBalls |= 1 << _player;
+            _onCourseBalls |= 1 << _player;
             return;
         }
     }
 
     void HandleInputMapExplorer()
     {
-        if (_arduboy.pressed(UP_BUTTON))
-            _camera.MoveUp();
-        if (_arduboy.pressed(DOWN_BUTTON))
-            _camera.MoveDown();
-        if (_arduboy.pressed(LEFT_BUTTON))
-            _camera.MoveLeft();
-        if (_arduboy.pressed(RIGHT_BUTTON))
-            _camera.MoveRight();
+        if (_arduboy.justPressed(A_BUTTON) && HasPrerenderedViews())
+        {
+            _overviewShift = 1;
+            _gameState = GameState::MapOverview;
+        }
+
+        PanFreeCamera(0);
+    }
+
+    // A zooms further out, then back into the map explorer
+    void HandleInputMapOverview()
+    {
+        if (_arduboy.justPressed(A_BUTTON) && ++_overviewShift > MaxOverviewShift)
+            _gameState = GameState::MapExplorer;
+
+        PanFreeCamera(_overviewShift);
+    }
+
+    // Scrolls the map explorer and its overview with the d-pad, the same distance on screen
+    // at every zoom level. Releasing B goes back to aiming.
+    void PanFreeCamera(uint8_t zoomShift)
+    {
+        int8_t dx = _arduboy.pressed(RIGHT_BUTTON) - _arduboy.pressed(LEFT_BUTTON);
+        int8_t dy = _arduboy.pressed(DOWN_BUTTON) - _arduboy.pressed(UP_BUTTON);
+        _camera.Pan(dx << zoomShift, dy << zoomShift);
+
+        // the camera then eases back to the ball
         if (_arduboy.justReleased(B_BUTTON))
         {
             _gameState = GameState::Aiming;
             _BButtonPressStartedDuringAim = false;
-            _camera.FocusOn(_ball.X, _ball.Y);
         }
     }
 
@@ -376,26 +502,35 @@ private:
 
     void HandleInputBallInMotion()
     {
-        // only start double speed upon a new button press
-        if (!_doubleSpeedEnabled)
-            _doubleSpeedEnabled = _arduboy.justPressed(A_BUTTON);
+        // only start fast-forward upon a new button press
+        if (!_fastForwardEnabled)
+            _fastForwardEnabled = _arduboy.justPressed(A_BUTTON);
         else
-            _doubleSpeedEnabled = _arduboy.pressed(A_BUTTON);
+            _fastForwardEnabled = _arduboy.pressed(A_BUTTON);
+
+        // choose the fast-forward speed (kept between shots)
+        if (_arduboy.justPressed(UP_BUTTON))
+            _fastForwardSpeedIdx = min(_fastForwardSpeedIdx + 1, NumFastForwardSpeeds - 1);
+        if (_arduboy.justPressed(DOWN_BUTTON))
+            _fastForwardSpeedIdx = max(0, _fastForwardSpeedIdx - 1);
     }
 
     void HandleInputMapComplete()
     {
         if (_arduboy.justPressed(A_BUTTON))
         {
-            if (_singleHoleMode)
+            if (_endlessMode)
+                BeginGeneratedHole(_holeGenerator.GetSeed() + 1);
+            else if (_singleHoleMode)
             {
                 _singleHoleMode = false;
-                _totalOverUnder = 0;
+                for (uint8_t p = 0; p < MaxPlayers; p++)
+                    _totalOverUnder[p] = 0;
                 _gameState = GameState::HoleSelection;
             }
             else
             {
-                if (_mapIndex >= MapManager::NumMaps - 1)
+                if (_holeIdx >= _course.numHoles - 1)
                     _gameState = GameState::GameSummary;
                 else
                     LoadNextMap();
@@ -413,71 +548,645 @@ private:
         }
     }
 
+    // 1 for normal playback, the fast-forward multiplier, or InstantSpeed
+    uint8_t GetPlaybackSpeed()
+    {
+        if (!_fastForwardEnabled)
+            return 1;
+        if (_fastForwardSpeedIdx == NumFastForwardSpeeds - 1)
+            return InstantSpeed;
+        return 2 << _fastForwardSpeedIdx;
+    }
+
+    // Runs the fixed-size physics steps owed for this frame. The number of steps per
+    // frame is bounded, so a rendered frame costs the same at any playback speed.
     void TickBallInMotion()
     {
-        // do a couple collision checks per tick
-        //  (less likely to miss a collision at high speeds)
-        uint8_t numCollisionChecks = 2;
-        float splitDelta = _secondsDelta / numCollisionChecks;
+        uint8_t speed = GetPlaybackSpeed();
+
+        if (speed == InstantSpeed)
+        {
+            // as many steps as fit in the frame's time budget
+            unsigned long start = micros();
+            while (_gameState == GameState::BallInMotion && micros() - start < InstantPhysicsMicrosPerFrame)
+                StepBallInMotion();
 
-        for (uint8_t i = 0; i < numCollisionChecks; i++)
+            _physicsSeconds = 0;
+            return;
+        }
+
+        _physicsSeconds += _secondsDelta * speed;
+
+        uint8_t steps = 0;
+        while (_gameState == GameState::BallInMotion && _physicsSeconds >= Ball::PhysicsStep)
         {
-            _ball.Move(splitDelta);
+            StepBallInMotion();
+            _physicsSeconds -= Ball::PhysicsStep;
 
-            if (_ball.IsStopped())
+            // drop the time we can't simulate this frame instead of building a backlog
+            if (++steps == MaxPhysicsStepsPerFrame)
             {
-                _gameState = GameState::Aiming;
-                _BButtonPressStartedDuringAim = false;
-                _ball.ResetPower();
-                _doubleSpeedEnabled = false;
+                _physicsSeconds = 0;
                 break;
             }
+        }
+    }
+
+    // Advances every rolling ball by one Ball::PhysicsStep, in one pass
+    void StepBallInMotion()
+    {
+        uint16_t tick = _moverTick++;
+
+        for (uint8_t i = 0; i < _numPlayers; i++)
+        {
+            if (_movingBalls & (1 << i))
+                StepBall(i, tick);
+        }
+
+        PushRestingBalls(tick, true);
+        HandleBallCollisions();
+
+        if (UsesGhost())
+        {
+            _ghostRecorder.Step(_balls[0]);
+            _ghost.Step();
+        }
 
-            CollisionHandler::HandleAllCollisions(_ball, _map, splitDelta);
+        if (_movingBalls == 0)
+            EndShot();
+    }
+
+    void StepBall(uint8_t player, uint16_t tick)
+    {
+        Ball &ball = _balls[player];
+        float fromX = ball.X;
+        float fromY = ball.Y;
+
+        // out of reach of the obstacles of a chunked map, it waits until the region comes to it
+        if (!_chunks.Covers(_map, ball.X, ball.Y))
+            return;
 
-            if (CollisionHandler::BallInHole(_ball, _map))
+        ball.Move();
+
+        uint8_t floorMaterial = _terrains[player].GetMaterial(_map, ball.X, ball.Y);
+        CollisionHandler::HandleTerrain(ball, floorMaterial);
+        bool pushed = _forceFields[player].Apply(_map, ball, tick);
+
+        if (ball.IsStopped())
+        {
+            _movingBalls &= ~(1 << player);
+            _contactFreeSteps[player] = 0;
+            return;
+        }
+
+        // free flight, nothing is close enough to be reached during this step. Terrain
+        // other than plain ground and force fields can speed the ball up, so it always
+        // checks collisions there.
+        if (floorMaterial != MaterialId::Default || pushed)
+            _contactFreeSteps[player] = 0;
+        else if (_contactFreeSteps[player] > 0)
+        {
+            --_contactFreeSteps[player];
+            return;
+        }
+
+        // obstacles are relative to the map's origin (see ChunkCache.h)
+        ball.X -= _map.originX;
+        ball.Y -= _map.originY;
+        CollisionHandler::HandleAllCollisions(ball, _map);
+        CollisionHandler::HandleMovers(ball, fromX - _map.originX, fromY - _map.originY, _map, tick);
+        uint8_t contactFreeSteps = CollisionHandler::GetContactFreeSteps(ball, _map);
+        ball.X += _map.originX;
+        ball.Y += _map.originY;
+
+        if (CollisionHandler::BallInHole(ball, _map))
+        {
+            ball.X = _map.end.x;
+            ball.Y = _map.end.y;
+            ball.Velocity = {0, 0};
+            _movingBalls &= ~(1 << player);
+            _holedBalls |= 1 << player;
+            return;
+        }
+
+        _contactFreeSteps[player] = contactFreeSteps;
+    }
+
+    // Keeps the obstacles of a chunked map around the screen loaded, once per frame. Unless
+    // the camera is free, the region also has to cover the ball the camera follows, so it is
+    // picked at most ChunkCache::CoverSlack from that ball. That is more than the camera's
+    // lead, so the screen stays covered as well once the camera has caught up. The
+    // contact-free steps were counted against the obstacles that were there before.
+    void UpdateChunks(bool freeCamera)
+    {
+        int16_t x = _camera.GetX() + WIDTH / 2;
+        int16_t y = _camera.GetY() + HEIGHT / 2;
+        if (!freeCamera)
+        {
+            const Ball &ball = FocusBall();
+            x = constrain(x, static_cast<int16_t>(ball.X) - ChunkCache::CoverSlack, static_cast<int16_t>(ball.X) + ChunkCache::CoverSlack);
+            y = constrain(y, static_cast<int16_t>(ball.Y) - ChunkCache::CoverSlack, static_cast<int16_t>(ball.Y) + ChunkCache::CoverSlack);
+        }
+
+        if (!_chunks.Update(_map, x, y))
+            return;
+
+        for (uint8_t i = 0; i < MaxPlayers; i++)
+            _contactFreeSteps[i] = 0;
+    }
+
+    // Ball-to-ball collisions between the balls on the course. Checked every step,
+    // independently of the contact-free steps, since other balls move too.
+    void HandleBallCollisions()
+    {
+        uint8_t inPlay = _onCourseBalls & ~_holedBalls;
+
+        for (uint8_t i = 0; i < _numPlayers; i++)
+        {
+            for (uint8_t j = i + 1; j < _numPlayers; j++)
             {
-                _ball.X = _map.end.x;
-                _ball.Y = _map.end.y;
-                _ball.Velocity = {0, 0};
-                _gameState = GameState::MapComplete;
-                _totalOverUnder += _strokes[_mapIndex] - _map.par;
-                break;
+                uint8_t pair = (1 << i) | (1 << j);
+                if ((inPlay & pair) != pair || (_movingBalls & pair) == 0)
+                    continue;
+
+                if (CollisionHandler::HandleCollisionBalls(_balls[i], _balls[j]))
+                {
+                    _movingBalls |= pair;
+                    _contactFreeSteps[i] = 0;
+                    _contactFreeSteps[j] = 0;
+                }
+            }
+        }
+    }
+
+    // Called once every ball has come to rest: passes the turn on, or ends the hole
+    // once every ball is in
+    void EndShot()
+    {
+        _fastForwardEnabled = false;
+        _physicsSeconds = 0;
+
+        if (UsesGhost())
+            _ghostRecorder.EndStroke(_balls[0]);
+
+        uint8_t allPlayers = (1 << _numPlayers) - 1;
+        if (_holedBalls == allPlayers)
+        {
+            _gameState = GameState::MapComplete;
+            _completedPar = _map.par;
+            for (uint8_t p = 0; p < _numPlayers; p++)
+                _totalOverUnder[p] += _strokes[p][_holeIdx] - _map.par;
+
+            if (UsesGhost())
+                _ghostRecorder.Finish();
+            _ghost.Hide();
+            return;
+        }
+
+        // the ghost waits where its next stroke starts
+        if (UsesGhost())
+            _ghost.SeekStroke(_strokes[0][_holeIdx]);
+
+        do
+            _player = (_player + 1) % _numPlayers;
+        while (_holedBalls & (1 << _player));
+
+        _gameState = GameState::Aiming;
+        _BButtonPressStartedDuringAim = false;
+        CurrentBall().ResetPower();
+    }
+
+    // Puts every ball back on the tee and gives the first turn to player 1
+    void ResetBalls()
+    {
+        for (uint8_t i = 0; i < MaxPlayers; i++)
+        {
+            _balls[i] = Ball(static_cast<float>(_map.start.x), static_cast<float>(_map.start.y));
+            _terrains[i] = Terrain();
+            _forceFields[i] = ForceField();
+            _contactFreeSteps[i] = 0;
+        }
+
+        _player = 0;
+        _movingBalls = 0;
+        _onCourseBalls = 0;
+        _holedBalls = 0;
+    }
+
+    Ball &CurrentBall()
+    {
+        return _balls[_player];
+    }
+
+    // Ball the camera follows: the current player's, unless it has stopped while balls it
+    // knocked are still rolling
+    Ball &FocusBall()
+    {
+        if (!(_movingBalls & (1 << _player)))
+        {
+            for (uint8_t i = 0; i < _numPlayers; i++)
+            {
+                if (_movingBalls & (1 << i))
+                    return _balls[i];
             }
         }
+
+        return CurrentBall();
+    }
+
+    uint16_t GetTotalStrokes(uint8_t player)
+    {
+        uint16_t total = 0;
+        for (uint8_t i = 0; i < MapManager::MaxCourseHoles; i++)
+            total += _strokes[player][i];
+        return total;
+    }
+
+    void TickChoosingPower()
+    {
+        CurrentBall().TickPower(_secondsDelta);
+    }
+
+    void TickMapSummary()
+    {
+        if (!_holeGenerator.IsDone())
+            TickHoleGenerator();
+    }
+
+    void DisplayStartScreen()
+    {
+        _camera.DrawStartScreen(_startScreenOptionIdx, _course.name, _numPlayers);
+    }
+
+    void DisplayHoleSelection()
+    {
+        _camera.DrawHoleSelection(_course, _holeSelectionIdx);
+    }
+
+    void DisplayInstructions()
+    {
+        _camera.DrawInstructions(_instructionsPageIdx);
+    }
+
+    void DisplayMapSummary()
+    {
+        if (!_holeGenerator.IsDone())
+            _camera.DrawGeneratingHole(GetHoleNumber());
+        else
+            _camera.DrawMapSummary(GetHoleNumber(), _map);
+    }
+
+    void DisplayAiming()
+    {
+        _camera.DrawAimHud(CurrentBall());
+        DrawPlayerIndicator();
+    }
+
+    void DisplayMapExplorer()
+    {
+        _camera.DrawForceField(_map);
+        _camera.DrawAimHud(CurrentBall());
+        _camera.DrawMapExplorerIndicator();
+    }
+
+    void DisplayMapOverview()
+    {
+        _camera.DrawOverview(_mapIndex, _overviewShift, _map, CurrentBall());
+    }
+
+    bool ShowsMinimap()
+    {
+        return _minimapEnabled && (GetStateInfo().flags & GameStateFlags::Minimap) && HasPrerenderedViews();
+    }
+
+    void DisplayPauseMenu()
+    {
+        _camera.DrawPauseMenu(GetHoleNumber(), _map, _strokes[_player][_holeIdx], _pauseOptionIdx);
+    }
+
+    void DisplayBallInMotion()
+    {
+        DrawPlayerIndicator();
+        if (_fastForwardEnabled)
+            _camera.DrawFastForwardIndicator(GetPlaybackSpeed());
+    }
+
+    void DisplayMapComplete()
+    {
+        if (HasNextHole())
+            _camera.HoldFrame();
+
+        if (_numPlayers > 1)
+            DrawScorecard(false);
+        else if (_singleHoleMode)
+            _camera.DrawMapCompleteNoTotal(GetHoleNumber(), _map, _strokes[0][_holeIdx]);
+        else
+            _camera.DrawMapComplete(GetHoleNumber(), _completedPar, _strokes[0][_holeIdx], _totalOverUnder[0]);
+    }
+
+    void DisplayGameSummary()
+    {
+        if (_numPlayers > 1)
+            DrawScorecard(true);
+        else
+            _camera.DrawGameSummary(GetTotalStrokes(0), _totalPar);
+    }
+
+    // Balls still on the tee are hidden, except the one about to tee off
+    void DrawBalls()
+    {
+        for (uint8_t i = 0; i < _numPlayers; i++)
+        {
+            bool visible = i == _player || (_onCourseBalls & (1 << i));
+            if (visible && !(_holedBalls & (1 << i) && i != _player))
+                _camera.DrawBall(_balls[i], i == _player);
+        }
+    }
+
+    void DrawPlayerIndicator()
+    {
+        if (_numPlayers > 1)
+            _camera.DrawPlayerIndicator(_player + 1);
+    }
+
+    // final = the whole game, otherwise the hole just completed
+    void DrawScorecard(bool final)
+    {
+        int16_t strokes[MaxPlayers];
+        int16_t overUnder[MaxPlayers];
+        for (uint8_t p = 0; p < _numPlayers; p++)
+        {
+            strokes[p] = final ? GetTotalStrokes(p) : _strokes[p][_holeIdx];
+            overUnder[p] = _totalOverUnder[p];
+        }
+
+        _camera.DrawScorecard(final ? 0 : GetHoleNumber(), strokes, overUnder, _numPlayers);
+    }
+
+    // Overviews and minimap thumbnails are prerendered for the maps in FX data, generated
+    // holes have none
+    bool HasPrerenderedViews()
+    {
+        return !_endlessMode && _mapIndex < MapOverviewHalfFrames && _mapIndex < MapThumbnailFrames;
     }
 
+    // Ghosts are kept per map, for a single player, as long as the save area has room for the map.
+    // They record 8 bit positions, so chunked maps have none.
+    bool UsesGhost()
+    {
+        return _numPlayers == 1 && !_endlessMode && _mapIndex < Ghosts::NumHoles && _map.chunkColumns == 0;
+    }
+
+    // Loads the hole's best round and starts recording this one
+    void BeginGhost()
+    {
+        if (!UsesGhost())
+        {
+            _ghost.Hide();
+            return;
+        }
+
+        _ghost.Load(_mapIndex);
+        _ghost.SeekStroke(0);
+        _ghostRecorder.Begin(_mapIndex);
+    }
+
+    void DrawGhost()
+    {
+        if (_ghost.IsVisible())
+            _camera.DrawGhostBall(_ghost.GetX(), _ghost.GetY());
+    }
+
+    // Keeps the moving obstacles going while the ball is at rest
+    void TickMovers()
+    {
+        _moverSeconds += _secondsDelta;
+        uint16_t ticks = static_cast<uint16_t>(_moverSeconds * (1 / Ball::PhysicsStep));
+        _moverSeconds -= ticks * Ball::PhysicsStep;
+
+        // one tick at a time, so a fast blade can't skip over a ball
+        while (ticks-- > 0)
+            PushRestingBalls(_moverTick++, false);
+    }
+
+    // Movers sweep through the balls at rest as well: the current player's ball and any ball
+    // waiting on the course. During a shot a ball that gets hit is knocked into motion,
+    // otherwise it is only pushed out of the way.
+    void PushRestingBalls(uint16_t tick, bool knock)
+    {
+        if (!_hasMovers || _preloading || !_holeGenerator.IsDone())
+            return;
+
+        uint8_t resting = (_onCourseBalls | (1 << _player)) & ~_holedBalls & ~_movingBalls;
+        for (uint8_t i = 0; i < _numPlayers; i++)
+        {
+            if (!(resting & (1 << i)))
+                continue;
+
+            // obstacles are relative to the map's origin (see ChunkCache.h)
+            Ball &ball = _balls[i];
+            float x = ball.X - _map.originX;
+            float y = ball.Y - _map.originY;
+            ball.X = x;
+            ball.Y = y;
+            CollisionHandler::HandleMovers(ball, x, y, _map, tick);
+            bool hit = ball.X != x || ball.Y != y;
+            if (hit)
+                CollisionHandler::HandleAllCollisions(ball, _map);
+            ball.X += _map.originX;
+            ball.Y += _map.originY;
+
+            if (!hit)
+                continue;
+
+            if (knock)
+            {
+                ball.Launch(ball.Velocity);
+                _movingBalls |= 1 << i;
+                _onCourseBalls |= 1 << i;
+                _contactFreeSteps[i] = 0;
+            }
+            else
+            {
+                ball.Velocity = {0, 0};
+            }
+        }
+    }
+
+    bool HasMovers()
+    {
+        for (auto mover : _map.movers)
+        {
+            if (!mover.IsEmpty())
+                return true;
+        }
+
+        return false;
+    }
+
+    bool HasNextHole()
+    {
+        return !_endlessMode && !_singleHoleMode && _holeIdx < _course.numHoles - 1;
+    }
+
+    // Stages the next hole into _map, a bounded piece per frame, so moving on from the
+    // hole complete screen doesn't stall. The screen holds the old hole's last frame.
+    void TickMapComplete()
+    {
+        if (!HasNextHole() || _preloaded)
+            return;
+
+        if (!_preloading)
+        {
+            _preloading = true;
+            _preloadProgress = 0;
+            _mapIndex = MapManager::GetMapIndex(_course, _holeIdx + 1);
+        }
+
+        _preloaded = MapManager::LoadMapStep(_mapIndex, _map, _preloadProgress);
+    }
+
+    // Swaps in the hole staged by TickMapComplete(), finishing the load first if the player
+    // moved on before it was done
     void LoadNextMap()
     {
-        _mapIndex += 1;
-        _map = MapManager::LoadMap(_mapIndex);
+        while (!_preloaded)
+            TickMapComplete();
+        _preloading = false;
+        _preloaded = false;
+
+        _holeIdx += 1;
+        _camera.Reset(_map.start.x, _map.start.y, _map.width, _map.height);
+        _chunks.Reset();
+        ResetBalls();
+        _hasMovers = HasMovers();
+        _gameState = GameState::MapSummary;
+        _secondsDelta = 0;
+    }
+
+    // Starts building the next endless mode hole into _map. The work is spread over the
+    // frames of the hole summary screen by TickHoleGenerator().
+    void BeginGeneratedHole(uint16_t seed)
+    {
+        ++_endlessHoleNum;
+        for (uint8_t p = 0; p < MaxPlayers; p++)
+            _strokes[p][_holeIdx] = 0;
 
-        _camera = Camera(_arduboy, 0, 0, _map.width, _map.height);
-        _ball = Ball(static_cast<float>(_map.start.x), static_cast<float>(_map.start.y));
+        _holeGenerator.Begin(seed);
         _gameState = GameState::MapSummary;
         _secondsDelta = 0;
     }
 
+    void TickHoleGenerator()
+    {
+        unsigned long start = micros();
+        while (micros() - start < HoleGeneratorMicrosPerFrame)
+        {
+            if (_holeGenerator.Step(_map))
+            {
+                _camera.Reset(_map.start.x, _map.start.y, _map.width, _map.height);
+                _chunks.Reset();
+                ResetBalls();
+                _hasMovers = false;
+                return;
+            }
+        }
+    }
+
+    uint8_t GetHoleNumber()
+    {
+        return _endlessMode ? _endlessHoleNum : _holeIdx + 1;
+    }
+
     bool IsBallNearHole()
     {
-        return CollisionHandler::Distance(_ball.X, _ball.Y, _map.end.x, _map.end.y) <= 25;
+        return CollisionHandler::Distance(CurrentBall().X, CurrentBall().Y, _map.end.x, _map.end.y) <= 25;
+    }
+
+    // Drop to the idle frame rate (and let the CPU sleep longer between frames)
+    // unless something is moving or the player is holding a button
+    void UpdateFrameRate()
+    {
+        bool fullRate = (GetStateInfo().flags & GameStateFlags::FullFrameRate) ||
+                        _arduboy.buttonsState() != 0;
+
+        uint8_t frameRate = fullRate ? FullFrameRate : IdleFrameRate;
+        if (frameRate != _frameRate)
+        {
+            _frameRate = frameRate;
+            _arduboy.setFrameRate(_frameRate);
+        }
+    }
+
+    GameStateInfo GetStateInfo()
+    {
+        GameStateInfo info;
+        memcpy_P(&info, &_stateTable[static_cast<uint8_t>(_gameState)], sizeof(info));
+        return info;
+    }
+
+    uint8_t GetMenuIdx()
+    {
+        GameStateInfo info = GetStateInfo();
+        return info.menuIdx != nullptr ? this->*info.menuIdx : 0;
     }
 
-    bool InPausableMode()
+    // Animations that are visible in the current state
+    uint8_t GetAnimationLayers()
     {
-        return _gameState == GameState::Aiming ||
-               _gameState == GameState::ChoosingPower ||
-               _gameState == GameState::MapExplorer ||
-               _gameState == GameState::BallInMotion;
+        GameStateInfo info = GetStateInfo();
+        return info.animationLayers | (ShowsMinimap() ? AnimationLayer::TextFlash : 0);
     }
 
-    static bool AnyButtonPressed(Arduboy2Base arduboy)
+    bool AnyButtonPressed()
     {
-        return (arduboy.justPressed(UP_BUTTON) ||
-                arduboy.justPressed(DOWN_BUTTON) ||
-                arduboy.justPressed(LEFT_BUTTON) ||
-                arduboy.justPressed(RIGHT_BUTTON) ||
-                arduboy.justPressed(A_BUTTON) ||
-                arduboy.justPressed(B_BUTTON));
+        return (_arduboy.justPressed(UP_BUTTON) ||
+                _arduboy.justPressed(DOWN_BUTTON) ||
+                _arduboy.justPressed(LEFT_BUTTON) ||
+                _arduboy.justPressed(RIGHT_BUTTON) ||
+                _arduboy.justPressed(A_BUTTON) ||
+                _arduboy.justPressed(B_BUTTON));
     }
-};
\ No newline at end of file
+};
+
+// One entry per GameState, in the order of the enum
+const GameStateInfo Game::_stateTable[NumGameStates] PROGMEM = {
+    // StartScreen
+    {&Game::HandleInputStartScreen, nullptr, &Game::DisplayStartScreen, &Game::_startScreenOptionIdx,
+     AnimationLayer::MenuFlag, 0},
+    // HoleSelection
+    {&Game::HandleInputHoleSelection, nullptr, &Game::DisplayHoleSelection, &Game::_holeSelectionIdx,
+     AnimationLayer::MenuFlag, 0},
+    // Instructions
+    {&Game::HandleInputInstructions, nullptr, &Game::DisplayInstructions, &Game::_instructionsPageIdx,
+     AnimationLayer::PageArrows, GameStateFlags::Background},
+    // MapSummary
+    {&Game::HandleInputMapSummary, &Game::TickMapSummary, &Game::DisplayMapSummary, nullptr,
+     AnimationLayer::Map | AnimationLayer::Border, GameStateFlags::NeedsMap},
+    // Aiming
+    {&Game::HandleInputAiming, nullptr, &Game::DisplayAiming, nullptr,
+     AnimationLayer::Map, GameStateFlags::Pausable | GameStateFlags::NeedsMap | GameStateFlags::Minimap},
+    // ChoosingPower
+    {&Game::HandleInputChoosingPower, &Game::TickChoosingPower, &Game::DisplayAiming, nullptr,
+     AnimationLayer::Map, GameStateFlags::Pausable | GameStateFlags::NeedsMap | GameStateFlags::FullFrameRate | GameStateFlags::Minimap},
+    // MapExplorer
+    {&Game::HandleInputMapExplorer, nullptr, &Game::DisplayMapExplorer, nullptr,
+     AnimationLayer::Map | AnimationLayer::TextFlash,
+     GameStateFlags::Pausable | GameStateFlags::NeedsMap | GameStateFlags::FullFrameRate | GameStateFlags::FreeCamera},
+    // MapOverview
+    {&Game::HandleInputMapOverview, nullptr, &Game::DisplayMapOverview, &Game::_overviewShift,
+     AnimationLayer::TextFlash, GameStateFlags::Pausable | GameStateFlags::FullFrameRate | GameStateFlags::FreeCamera},
+    // PauseMenu
+    {&Game::HandleInputPauseMenu, nullptr, &Game::DisplayPauseMenu, &Game::_pauseOptionIdx,
+     AnimationLayer::Border, GameStateFlags::Background},
+    // BallInMotion
+    {&Game::HandleInputBallInMotion, nullptr, &Game::DisplayBallInMotion, nullptr,
+     AnimationLayer::Map | AnimationLayer::TextFlash,
+     GameStateFlags::Pausable | GameStateFlags::PhysicsActive | GameStateFlags::NeedsMap | GameStateFlags::FullFrameRate},
+    // MapComplete
+    {&Game::HandleInputMapComplete, &Game::TickMapComplete, &Game::DisplayMapComplete, nullptr,
+     AnimationLayer::Map | AnimationLayer::Border, GameStateFlags::NeedsMap},
+    // GameSummary
+    {&Game::HandleInputGameSummary, nullptr, &Game::DisplayGameSummary, nullptr,
+     AnimationLayer::Border, 0},
+};
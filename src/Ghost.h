@@ -0,0 +1,352 @@
+#pragma once
+
+#include "Ball.h"
+#include "FX/ArduboyFX.h"
+#include "FX/fxdata.h"
+#include <Arduboy2.h>
+
+// Personal-best round of every hole, kept in the FX save area so it can be replayed as
+// a ghost ball. Nothing is simulated on playback: the round is stored as keyframes of the
+// ball's position, one every KeyframeSteps physics steps, and decoded a couple of bytes at a time.
+//
+// Every hole owns two 4KB flash blocks (the smallest erasable unit). One holds the best
+// round, the other one records the round being played, so a new best only needs its
+// header byte written instead of a copy. Block layout:
+//   0      strokes of the round (0xFF while erased or the round wasn't a new best)
+//   2      uint16_t offset of every stroke, plus the end of the last stroke
+//   32...  per stroke: start position (uint8_t x, y), then int8_t dx, dy keyframes in half pixels
+class Ghosts
+{
+    Ghosts() = delete; // enforce this to be a static class
+
+public:
+    static constexpr uint8_t KeyframeSteps = 8; // Ball::PhysicsSteps between keyframes
+    static constexpr uint8_t MaxStrokes = 14;   // rounds with more strokes aren't kept
+    static constexpr uint16_t BlockBytes = 4096;
+    static constexpr uint8_t BlocksPerHole = 2;
+    static constexpr uint8_t NumHoles = (FX_SAVE_BYTES + BlockBytes - 1) / BlockBytes / BlocksPerHole; // maps with a ghost
+    static constexpr uint8_t NoRound = 0xFF;
+
+    static constexpr uint8_t StrokesOffset = 0;
+    static constexpr uint8_t StrokeOffsetsOffset = 2;
+    static constexpr uint8_t HeaderBytes = 32;
+
+    static uint24_t GetBlockAddress(uint8_t mapIndex, uint8_t slot)
+    {
+        return static_cast<uint24_t>(mapIndex * BlocksPerHole + slot) * BlockBytes;
+    }
+
+    // Strokes of the round stored in a block, NoRound if there is none
+    static uint8_t ReadStrokes(uint8_t mapIndex, uint8_t slot)
+    {
+        uint8_t strokes;
+        FX::readSaveBytes(GetBlockAddress(mapIndex, slot) + StrokesOffset, &strokes, 1);
+        return strokes > MaxStrokes ? NoRound : strokes;
+    }
+
+    // Block of the hole's best round. If neither block holds one, any block will do.
+    static uint8_t FindBestSlot(uint8_t mapIndex)
+    {
+        return ReadStrokes(mapIndex, 1) < ReadStrokes(mapIndex, 0) ? 1 : 0;
+    }
+
+    // Programs bytes into erased flash of the save area. Erased bits can only be cleared,
+    // so every byte is written at most once after its block was erased.
+    static void Write(uint24_t address, const uint8_t *data, uint8_t length)
+    {
+        while (length > 0)
+        {
+            // a single program command can't cross a 256 byte flash page
+            uint16_t pageSpace = 256 - (address & 0xFF);
+            uint8_t count = min(static_cast<uint16_t>(length), pageSpace);
+
+            FX::writeEnable();
+            FX::seekCommand(SFC_WRITE, (static_cast<uint24_t>(FX::programSavePage) << 8) + address);
+            for (uint8_t i = 0; i < count; i++)
+                FX::writeByte(data[i]);
+            FX::disable();
+
+            // flash can't be read until the write is done
+            FX::waitWhileBusy();
+
+            address += count;
+            data += count;
+            length -= count;
+        }
+    }
+
+    // True if nothing was written to the block since it was erased. Every recording writes
+    // its first stroke offset before anything else, so an erased header means an erased block.
+    static bool IsErased(uint8_t mapIndex, uint8_t slot)
+    {
+        uint8_t header[HeaderBytes / 4];
+        for (uint8_t offset = 0; offset < HeaderBytes; offset += sizeof(header))
+        {
+            FX::readSaveBytes(GetBlockAddress(mapIndex, slot) + offset, header, sizeof(header));
+            for (uint8_t value : header)
+            {
+                if (value != 0xFF)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Blocks for tens to hundreds of milliseconds
+    static void Erase(uint8_t mapIndex, uint8_t slot)
+    {
+        FX::eraseSaveBlock(GetBlockAddress(mapIndex, slot) >> 8);
+        FX::waitWhileBusy();
+    }
+};
+
+// Records the round being played into the hole's spare block
+class GhostRecorder
+{
+public:
+    // Picks the spare block of the hole. It is only erased once the round writes to it,
+    // and not at all if nothing was written to it since its last erase.
+    void Begin(uint8_t mapIndex)
+    {
+        _mapIndex = mapIndex;
+        _slot = 1 - Ghosts::FindBestSlot(mapIndex);
+        _best = Ghosts::ReadStrokes(mapIndex, 1 - _slot);
+        _address = Ghosts::HeaderBytes;
+        _strokes = 0;
+        _bufferCount = 0;
+        _full = false;
+        _erased = Ghosts::IsErased(_mapIndex, _slot);
+    }
+
+    void StartStroke(const Ball &ball)
+    {
+        if (_strokes >= Ghosts::MaxStrokes)
+            _full = true;
+        if (_full)
+            return;
+
+        WriteOffset(_strokes, _address);
+
+        uint8_t x = static_cast<uint8_t>(ball.X);
+        uint8_t y = static_cast<uint8_t>(ball.Y);
+        _lastX = x * 2;
+        _lastY = y * 2;
+        _step = 0;
+        Append(x, y);
+    }
+
+    // Call after every Ball::PhysicsStep of the stroke
+    void Step(const Ball &ball)
+    {
+        if (++_step == Ghosts::KeyframeSteps)
+        {
+            _step = 0;
+            AppendKeyframe(ball);
+        }
+    }
+
+    void EndStroke(const Ball &ball)
+    {
+        if (_step > 0)
+            AppendKeyframe(ball);
+
+        Flush();
+        ++_strokes;
+    }
+
+    // Keeps the round as the hole's ghost if it beat the best one. Returns true if it did.
+    bool Finish()
+    {
+        if (_full || _strokes == 0 || _strokes >= _best)
+            return false;
+
+        WriteOffset(_strokes, _address);
+
+        // written last: until then the block doesn't count as a round
+        Ghosts::Write(Ghosts::GetBlockAddress(_mapIndex, _slot) + Ghosts::StrokesOffset, &_strokes, 1);
+        return true;
+    }
+
+private:
+    static constexpr uint8_t BufferSize = 16;
+
+    uint8_t _mapIndex;
+    uint8_t _slot;
+    uint8_t _best;
+    uint16_t _address; // next free byte in the block
+    uint8_t _strokes;
+    bool _full;        // ran out of space, the round can't be kept
+    bool _erased;      // the spare block is ready to be written
+    uint8_t _step;     // physics steps since the last keyframe
+    int16_t _lastX, _lastY; // last encoded position in half pixels
+    uint8_t _buffer[BufferSize];
+    uint8_t _bufferCount;
+
+    void AppendKeyframe(const Ball &ball)
+    {
+        int16_t dx = constrain(static_cast<int16_t>(ball.X * 2) - _lastX, INT8_MIN, INT8_MAX);
+        int16_t dy = constrain(static_cast<int16_t>(ball.Y * 2) - _lastY, INT8_MIN, INT8_MAX);
+        _lastX += dx;
+        _lastY += dy;
+        Append(static_cast<uint8_t>(dx), static_cast<uint8_t>(dy));
+    }
+
+    void Append(uint8_t a, uint8_t b)
+    {
+        if (_full || _address + _bufferCount + 2 > Ghosts::BlockBytes)
+        {
+            _full = true;
+            return;
+        }
+
+        _buffer[_bufferCount++] = a;
+        _buffer[_bufferCount++] = b;
+        if (_bufferCount == BufferSize)
+            Flush();
+    }
+
+    void Flush()
+    {
+        if (_bufferCount == 0)
+            return;
+
+        EnsureErased();
+        Ghosts::Write(Ghosts::GetBlockAddress(_mapIndex, _slot) + _address, _buffer, _bufferCount);
+        _address += _bufferCount;
+        _bufferCount = 0;
+    }
+
+    void WriteOffset(uint8_t stroke, uint16_t offset)
+    {
+        EnsureErased();
+        uint24_t address = Ghosts::GetBlockAddress(_mapIndex, _slot) + Ghosts::StrokeOffsetsOffset + stroke * 2;
+        Ghosts::Write(address, reinterpret_cast<const uint8_t *>(&offset), 2);
+    }
+
+    // Erases the spare block before its first write of the round
+    void EnsureErased()
+    {
+        if (_erased)
+            return;
+
+        Ghosts::Erase(_mapIndex, _slot);
+        _erased = true;
+    }
+};
+
+// Replays the hole's best round, one stroke at a time in sync with the player's strokes
+class GhostPlayer
+{
+public:
+    void Load(uint8_t mapIndex)
+    {
+        uint8_t slot = Ghosts::FindBestSlot(mapIndex);
+        _block = Ghosts::GetBlockAddress(mapIndex, slot);
+        _strokes = Ghosts::ReadStrokes(mapIndex, slot);
+        _visible = false;
+        _moving = false;
+    }
+
+    void Hide()
+    {
+        _visible = false;
+        _moving = false;
+    }
+
+    bool HasRound() const
+    {
+        return _strokes != Ghosts::NoRound;
+    }
+
+    // Puts the ghost where the given stroke (0 = tee shot) starts, at rest. Once the best
+    // round is over the ghost is in the hole and isn't shown anymore.
+    void SeekStroke(uint8_t stroke)
+    {
+        _moving = false;
+        _visible = HasRound() && stroke < _strokes;
+        if (!_visible)
+            return;
+
+        uint16_t offsets[2];
+        FX::readSaveBytes(_block + Ghosts::StrokeOffsetsOffset + stroke * 2, reinterpret_cast<uint8_t *>(offsets), sizeof(offsets));
+        _address = offsets[0];
+        _end = offsets[1];
+
+        uint8_t start[2];
+        ReadBytes(start);
+        _x = _nextX = start[0] * 2;
+        _y = _nextY = start[1] * 2;
+    }
+
+    // Starts replaying the stroke selected with SeekStroke()
+    void Play()
+    {
+        if (!_visible)
+            return;
+
+        _moving = true;
+        _step = 0;
+        ReadKeyframe();
+    }
+
+    // Call after every Ball::PhysicsStep of the player's stroke
+    void Step()
+    {
+        if (!_moving || ++_step < Ghosts::KeyframeSteps)
+            return;
+
+        _step = 0;
+        _x = _nextX;
+        _y = _nextY;
+        ReadKeyframe();
+    }
+
+    bool IsVisible() const
+    {
+        return _visible;
+    }
+
+    // Position interpolated between the keyframes, in pixels
+    int16_t GetX() const
+    {
+        return (_x + (_nextX - _x) * _step / Ghosts::KeyframeSteps) / 2;
+    }
+
+    int16_t GetY() const
+    {
+        return (_y + (_nextY - _y) * _step / Ghosts::KeyframeSteps) / 2;
+    }
+
+private:
+    uint24_t _block;
+    uint8_t _strokes = Ghosts::NoRound;
+    uint16_t _address; // next keyframe within the block
+    uint16_t _end;     // end of the current stroke within the block
+    bool _visible = false;
+    bool _moving = false;
+    uint8_t _step;
+    int16_t _x, _y;         // previous keyframe in half pixels
+    int16_t _nextX, _nextY; // keyframe the ghost is heading to
+
+    void ReadKeyframe()
+    {
+        if (_address >= _end)
+        {
+            _moving = false;
+            _step = 0;
+            return;
+        }
+
+        int8_t delta[2];
+        ReadBytes(reinterpret_cast<uint8_t *>(delta));
+        _nextX = _x + delta[0];
+        _nextY = _y + delta[1];
+    }
+
+    void ReadBytes(uint8_t *bytes)
+    {
+        FX::readSaveBytes(_block + _address, bytes, 2);
+        _address += 2;
+    }
+};
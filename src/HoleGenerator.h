@@ -0,0 +1,412 @@
+#pragma once
+
+#include "Ball.h"
+#include "Map.h"
+#include "Material.h"
+#include "Terrain.h"
+#include "UIText.h"
+#include <Arduboy2.h>
+
+// Builds random holes for the endless mode into a regular Map: a corridor of baffle walls,
+// a field of pegs and a few sand and treadmill patches. The same seed always gives the same hole.
+//
+// The work is split in small steps so the caller can spread it over several frames. The
+// last stage checks that the hole can be reached from the tee with a flood fill over 16x16
+// pixel cells; if it can't, generation starts over with the next seed.
+class HoleGenerator
+{
+public:
+    void Begin(uint16_t seed)
+    {
+        _seed = seed;
+        _stage = Stage::Layout;
+    }
+
+    bool IsDone() const
+    {
+        return _stage == Stage::Done;
+    }
+
+    // Seed of the hole, once done. Differs from the one passed to Begin() if that one gave
+    // an unplayable hole.
+    uint16_t GetSeed() const
+    {
+        return _seed;
+    }
+
+    // Runs one small piece of the generation. Returns true once the map is complete.
+    bool Step(Map &map)
+    {
+        switch (_stage)
+        {
+            case Stage::Layout:
+                GenerateLayout(map);
+                _stage = Stage::Pegs;
+                break;
+            case Stage::Pegs:
+                if (!GeneratePeg(map))
+                    _stage = Stage::Patches;
+                break;
+            case Stage::Patches:
+                if (!GeneratePatch(map))
+                    BeginValidation(map);
+                break;
+            case Stage::Validate:
+                Validate(map);
+                break;
+            case Stage::Done:
+                break;
+        }
+
+        return IsDone();
+    }
+
+private:
+    enum class Stage : uint8_t
+    {
+        Layout,
+        Pegs,
+        Patches,
+        Validate,
+        Done
+    };
+
+    static constexpr uint8_t MinGap = 24; // room left at the end of a baffle
+    static constexpr uint8_t MaxBaffles = 4;
+    static constexpr uint8_t MaxPegs = 6;
+    static constexpr uint8_t PegAttempts = 4;
+    static constexpr uint8_t ClearRadius = 16; // pegs and patches stay this far from the tee and the hole
+
+    // flood fill grid
+    static constexpr uint8_t CellShift = 4;
+    static constexpr uint8_t CellSize = 1 << CellShift;
+    static constexpr uint8_t GridSize = 16; // cells per side, covers 256 pixels
+    static constexpr uint8_t GridBytes = GridSize * GridSize / 8;
+
+    uint16_t _seed;
+    uint16_t _random;
+    Stage _stage = Stage::Done;
+    uint8_t _numBaffles;
+    uint8_t _pegsLeft;
+    uint8_t _patchesLeft;
+    uint8_t _columns, _rows; // flood fill cells covering the map
+    uint8_t _cursor;         // next cell the flood fill looks at
+    uint8_t _idleCells;      // cells looked at since the last one was expanded
+    uint8_t _reached[GridBytes];  // cells the ball can get to
+    uint8_t _expanded[GridBytes]; // reached cells whose neighbours were checked
+    char _name[11];               // "Seed 65535"
+
+    // 16 bit xorshift, small and the same on every platform
+    uint16_t Random()
+    {
+        _random ^= _random << 7;
+        _random ^= _random >> 9;
+        _random ^= _random << 8;
+        return _random;
+    }
+
+    uint8_t Random(uint8_t min, uint8_t max)
+    {
+        return min + Random() % (max - min + 1);
+    }
+
+    void GenerateLayout(Map &map)
+    {
+        _random = _seed == 0 ? 1 : _seed;
+
+        map = Map();
+        map.width = 32 * Random(4, 7);
+        map.height = 32 * Random(2, 4);
+        map.terrain = Terrain::PatchGrid;
+        Terrain::ClearPatches();
+
+        uint8_t right = map.width - 1;
+        uint8_t bottom = map.height - 1;
+        map.walls[0] = Wall(0, 0, right, 0);
+        map.walls[1] = Wall(right, 0, right, bottom);
+        map.walls[2] = Wall(right, bottom, 0, bottom);
+        map.walls[3] = Wall(0, bottom, 0, 0);
+
+        // baffles sit on flood fill cell borders, alternating from the top and the bottom
+        _numBaffles = Random(0, min(MaxBaffles, static_cast<uint8_t>(map.width / 48)));
+        bool fromTop = Random() & 1;
+        for (uint8_t i = 0; i < _numBaffles; i++)
+        {
+            uint8_t x = (map.width * (i + 1) / (_numBaffles + 1)) & ~(CellSize - 1);
+            uint8_t gap = Random(MinGap, MinGap + 8);
+            uint8_t material = Random(0, 3) == 0 ? MaterialId::Rubber : MaterialId::Default;
+
+            if (fromTop)
+                map.walls[4 + i] = Wall(x, 0, x, bottom - gap, material);
+            else
+                map.walls[4 + i] = Wall(x, gap, x, bottom, material);
+
+            fromTop = !fromTop;
+        }
+
+        map.start = Point16(12, map.height / 2);
+        map.end = Point16(map.width - 12, Random(12, map.height - 12));
+
+        _pegsLeft = Random(0, MaxPegs);
+        _patchesLeft = Random(0, Terrain::MaxPatches);
+        map.par = 2 + (_numBaffles + 1) / 2 + (_pegsLeft > MaxPegs / 2);
+
+        WriteName(map);
+    }
+
+    // Places the next peg. Returns false once all are placed.
+    bool GeneratePeg(Map &map)
+    {
+        if (_pegsLeft == 0)
+            return false;
+
+        uint8_t index = MaxPegs - _pegsLeft;
+        --_pegsLeft;
+
+        for (uint8_t attempt = 0; attempt < PegAttempts; attempt++)
+        {
+            uint8_t radius = Random(3, 5);
+            uint8_t x = Random(radius + 6, map.width - radius - 7);
+            uint8_t y = Random(radius + 6, map.height - radius - 7);
+
+            if (IsPegClear(map, x, y, radius))
+            {
+                map.circles[index] = Circle(x, y, radius, Random(0, 2) == 0 ? MaterialId::Rubber : MaterialId::Default);
+                return true;
+            }
+        }
+
+        return true;
+    }
+
+    bool IsPegClear(const Map &map, uint8_t x, uint8_t y, uint8_t radius)
+    {
+        if (IsNear(x, y, map.start.x, map.start.y, ClearRadius + radius) || IsNear(x, y, map.end.x, map.end.y, ClearRadius + radius))
+            return false;
+
+        // keep the gaps at the end of the baffles open
+        for (uint8_t i = 0; i < _numBaffles; i++)
+        {
+            if (abs(x - map.walls[4 + i].p1.x) < radius + 10)
+                return false;
+        }
+
+        for (auto &circle : map.circles)
+        {
+            if (!circle.IsEmpty() && IsNear(x, y, circle.location.x, circle.location.y, circle.radius + radius + 10))
+                return false;
+        }
+
+        return true;
+    }
+
+    // Adds the next terrain patch. Returns false once all are added.
+    bool GeneratePatch(Map &map)
+    {
+        if (_patchesLeft == 0)
+            return false;
+
+        --_patchesLeft;
+
+        TerrainPatch patch;
+        switch (Random(0, 3))
+        {
+            case 0:
+            case 1:
+                patch.columns = Random(2, 4);
+                patch.rows = Random(2, 3);
+                patch.material = MaterialId::Sand;
+                break;
+            case 2: // horizontal belt
+                patch.columns = Random(4, 6);
+                patch.rows = 1;
+                patch.material = Random() & 1 ? MaterialId::TreadmillLeft : MaterialId::TreadmillRight;
+                break;
+            default: // vertical belt
+                patch.columns = 1;
+                patch.rows = Random(3, 5);
+                patch.material = Random() & 1 ? MaterialId::TreadmillUp : MaterialId::TreadmillDown;
+                break;
+        }
+
+        uint8_t columns = map.width >> Terrain::CellShift;
+        uint8_t rows = map.height >> Terrain::CellShift;
+        patch.column = Random(1, columns - patch.columns - 1);
+        patch.row = Random(1, rows - patch.rows - 1);
+
+        if (!IsPatchClear(patch, map.start) || !IsPatchClear(patch, map.end))
+            return true;
+
+        Terrain::AddPatch(patch);
+        return true;
+    }
+
+    static bool IsPatchClear(const TerrainPatch &patch, const Point16 &point)
+    {
+        int16_t left = (patch.column << Terrain::CellShift) - ClearRadius;
+        int16_t top = (patch.row << Terrain::CellShift) - ClearRadius;
+        int16_t right = ((patch.column + patch.columns) << Terrain::CellShift) + ClearRadius;
+        int16_t bottom = ((patch.row + patch.rows) << Terrain::CellShift) + ClearRadius;
+
+        int16_t x = point.x;
+        int16_t y = point.y;
+        return x < left || x >= right || y < top || y >= bottom;
+    }
+
+    void BeginValidation(const Map &map)
+    {
+        _columns = map.width >> CellShift;
+        _rows = map.height >> CellShift;
+        memset(_reached, 0, GridBytes);
+        memset(_expanded, 0, GridBytes);
+
+        uint8_t startCell = GetCell(map.start);
+        SetBit(_reached, startCell);
+        _cursor = startCell;
+        _idleCells = 0;
+        _stage = Stage::Validate;
+    }
+
+    // Expands one reached cell of the flood fill into its neighbours
+    void Validate(const Map &map)
+    {
+        if (GetBit(_reached, GetCell(map.end)))
+        {
+            _stage = Stage::Done;
+            return;
+        }
+
+        // look for a reached cell that wasn't expanded yet
+        while (!GetBit(_reached, _cursor) || GetBit(_expanded, _cursor))
+        {
+            ++_cursor; // wraps around after the last cell
+            if (++_idleCells == 0)
+            {
+                // every reached cell was expanded without getting to the hole
+                Begin(_seed + 1);
+                return;
+            }
+        }
+
+        _idleCells = 0;
+        SetBit(_expanded, _cursor);
+
+        uint8_t column = _cursor % GridSize;
+        uint8_t row = _cursor / GridSize;
+        if (column > 0)
+            TryReach(map, _cursor, _cursor - 1);
+        if (column < _columns - 1)
+            TryReach(map, _cursor, _cursor + 1);
+        if (row > 0)
+            TryReach(map, _cursor, _cursor - GridSize);
+        if (row < _rows - 1)
+            TryReach(map, _cursor, _cursor + GridSize);
+    }
+
+    void TryReach(const Map &map, uint8_t from, uint8_t to)
+    {
+        if (!GetBit(_reached, to) && !IsPathBlocked(map, from, to))
+            SetBit(_reached, to);
+    }
+
+    // True if a wall or a peg is in the way between the centers of two neighbouring cells
+    static bool IsPathBlocked(const Map &map, uint8_t from, uint8_t to)
+    {
+        int16_t x1 = (from % GridSize) * CellSize + CellSize / 2;
+        int16_t y1 = (from / GridSize) * CellSize + CellSize / 2;
+        int16_t x2 = (to % GridSize) * CellSize + CellSize / 2;
+        int16_t y2 = (to / GridSize) * CellSize + CellSize / 2;
+
+        for (auto &wall : map.walls)
+        {
+            if (!wall.IsEmpty() && SegmentsIntersect(x1, y1, x2, y2, wall.p1.x, wall.p1.y, wall.p2.x, wall.p2.y))
+                return true;
+        }
+
+        // the path is axis aligned, so its closest point to a peg is a clamp
+        for (auto &circle : map.circles)
+        {
+            if (circle.IsEmpty())
+                continue;
+
+            int16_t cx = circle.location.x;
+            int16_t cy = circle.location.y;
+            int16_t dx = constrain(cx, min(x1, x2), max(x1, x2)) - cx;
+            int16_t dy = constrain(cy, min(y1, y2), max(y1, y2)) - cy;
+            int16_t reach = circle.radius + Ball::Radius;
+            if (dx * dx + dy * dy < reach * reach)
+                return true;
+        }
+
+        return false;
+    }
+
+    // Touching counts as intersecting
+    static bool SegmentsIntersect(int16_t ax, int16_t ay, int16_t bx, int16_t by,
+                                  int16_t cx, int16_t cy, int16_t dx, int16_t dy)
+    {
+        int8_t d1 = Orientation(cx, cy, dx, dy, ax, ay);
+        int8_t d2 = Orientation(cx, cy, dx, dy, bx, by);
+        int8_t d3 = Orientation(ax, ay, bx, by, cx, cy);
+        int8_t d4 = Orientation(ax, ay, bx, by, dx, dy);
+
+        if (d1 * d2 > 0 || d3 * d4 > 0)
+            return false;
+
+        // collinear: overlapping bounding boxes
+        if (d1 == 0 && d2 == 0)
+            return max(ax, bx) >= min(cx, dx) && max(cx, dx) >= min(ax, bx) &&
+                   max(ay, by) >= min(cy, dy) && max(cy, dy) >= min(ay, by);
+
+        return true;
+    }
+
+    // Side of the line a->b that point p is on: 1, -1, or 0 on the line
+    static int8_t Orientation(int16_t ax, int16_t ay, int16_t bx, int16_t by, int16_t px, int16_t py)
+    {
+        int32_t cross = static_cast<int32_t>(bx - ax) * (py - ay) - static_cast<int32_t>(by - ay) * (px - ax);
+        return (cross > 0) - (cross < 0);
+    }
+
+    static bool IsNear(uint8_t x, uint8_t y, uint16_t pointX, uint16_t pointY, uint8_t distance)
+    {
+        int16_t dx = x - pointX;
+        int16_t dy = y - pointY;
+        return dx * dx + dy * dy < distance * distance;
+    }
+
+    static uint8_t GetCell(const Point16 &point)
+    {
+        return (point.y >> CellShift) * GridSize + (point.x >> CellShift);
+    }
+
+    static bool GetBit(const uint8_t *bits, uint8_t index)
+    {
+        return bits[index / 8] & (1 << (index % 8));
+    }
+
+    static void SetBit(uint8_t *bits, uint8_t index)
+    {
+        bits[index / 8] |= 1 << (index % 8);
+    }
+
+    void WriteName(Map &map)
+    {
+        memcpy(_name, UIText::Read(UIText::Seed), 5);
+
+        char digits[5];
+        uint8_t count = 0;
+        uint16_t value = _seed;
+        do
+        {
+            digits[count++] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+
+        for (uint8_t i = 0; i < count; i++)
+            _name[5 + i] = digits[count - 1 - i];
+        _name[5 + count] = '\0';
+
+        map.name = _name;
+    }
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "FX/ArduboyFX.h"
 #include <Arduboy2.h>
 
 struct Point8
@@ -16,16 +17,28 @@ struct Point8
     }
 };
 
+// Map position, for the points that can lie anywhere on a map larger than 255 pixels
+struct Point16
+{
+    uint16_t x;
+    uint16_t y;
+
+    Point16() = default;
+    Point16(uint16_t x, uint16_t y) : x(x), y(y) {}
+};
+
 struct Wall
 {
     Point8 p1;
     Point8 p2;
+    uint8_t material; // index into the Materials table
 
     Wall() = default;
-    Wall(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+    Wall(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t material = 0)
     {
         p1 = Point8(x1, y1);
         p2 = Point8(x2, y2);
+        this->material = material;
     }
 
     bool IsEmpty()
@@ -38,12 +51,14 @@ struct Circle
 {
     Point8 location;
     uint8_t radius;
+    uint8_t material; // index into the Materials table
 
     Circle() = default;
-    Circle(uint8_t x, uint8_t y, uint8_t r)
+    Circle(uint8_t x, uint8_t y, uint8_t r, uint8_t material = 0)
     {
         location = Point8(x, y);
         radius = r;
+        this->material = material;
     }
 
     bool IsEmpty()
@@ -52,69 +67,94 @@ struct Circle
     }
 };
 
-struct SandTrap
+// Solid convex obstacle, resolved with a single query instead of one test per edge
+struct Polygon
 {
-    static constexpr float FrictionMultiplier = 6; // each frame, apply extra friction to the ball
+    static constexpr uint8_t MaxVertices = 6;
 
-    uint8_t x;
-    uint8_t y;
-    uint8_t width;
-    uint8_t height;
+    uint8_t vertexCount;          // 0 for an unused slot
+    uint8_t material;             // index into the Materials table
+    Point8 vertices[MaxVertices]; // convex, in either winding order
 
-    SandTrap() = default;
-    SandTrap(uint8_t x, uint8_t y, uint8_t width, uint8_t height)
-        : x(x), y(y), width(width), height(height) {}
+    // precomputed by MapManager::LoadMap
+    Point8 center;                // bounding circle
+    uint8_t radius;
+    int8_t normalX[MaxVertices];  // outward unit normal of the edge from vertex i to i + 1, scaled by 127
+    int8_t normalY[MaxVertices];
 
-    bool IsEmpty()
+    bool IsEmpty() const
     {
-        return width == 0 && height == 0;
+        return vertexCount == 0;
     }
 };
 
-enum class Direction : uint8_t
+enum class MoverType : uint8_t
 {
-    Up,
-    Down,
-    Left,
-    Right
+    None,
+    Rotor,  // windmill blade spinning around its center
+    Slider, // wall sliding back and forth
+    Block   // rectangle sliding back and forth
 };
 
-struct Treadmill
+// Moving obstacle. Its position is a function of the global mover clock only (see Movers.h),
+// so it has no state to update.
+struct Mover
 {
-    static constexpr float Speed = 100; // velocity added to ball every second
-
-    uint8_t x;
-    uint8_t y;
-    uint8_t width;
-    uint8_t height;
-    Direction direction;
-
-    Treadmill() = default;
-    Treadmill(uint8_t x, uint8_t y, uint8_t width, uint8_t height, Direction direction)
-        : x(x), y(y), width(width), height(height), direction(direction) {}
+    MoverType type;
+    Point8 a;            // Rotor: pivot. Slider: first end of the wall. Block: top-left corner
+    Point8 b;            // Rotor: blade half-length in x, y unused. Slider: second end. Block: width and height
+    int8_t travelX;      // Slider and Block: offset at the far end of the stroke
+    int8_t travelY;
+    uint8_t periodShift; // one cycle (a full turn, or there and back) takes 2^periodShift Ball::PhysicsSteps
+    uint8_t phase;       // offset into the cycle, in 1/256ths
+    uint8_t material;    // index into the Materials table
 
     bool IsEmpty()
     {
-        return width == 0 && height == 0;
+        return type == MoverType::None;
     }
 };
 
+// Obstacles of one square chunk of a chunked map, in coordinates relative to the chunk's
+// top left corner. Stored in ObstacleChunks in FX data, one chunk after the other.
+struct MapChunk
+{
+    static constexpr uint8_t NumWalls = 5;
+    static constexpr uint8_t NumCircles = 3;
+
+    Wall walls[NumWalls];
+    Circle circles[NumCircles];
+};
+
 struct Map
 {
     static constexpr uint8_t HoleRadius = 3;
     static constexpr uint8_t MaxNumWalls = 21;
     static constexpr uint8_t MaxNumCircles = 14;
-    static constexpr uint8_t MaxNumSandTraps = 6;
-    static constexpr uint8_t MaxNumTreadmills = 5;
+    static constexpr uint8_t MaxNumPolygons = 2;
+    static constexpr uint8_t MaxNumMovers = 4;
 
     uint8_t par;
-    uint8_t width;
-    uint8_t height;
-    Point8 start;
-    Point8 end;
+    uint16_t width;
+    uint16_t height;
+    Point16 start;
+    Point16 end;
     const char *name;
+    uint24_t terrain; // FX address of this map's grid in TerrainGrids (see Terrain.h)
+    uint24_t forces;  // FX address of this map's grid in ForceFields, 0 = none (see ForceField.h)
+    uint8_t forceFlags;
+
+    // Obstacles are in coordinates relative to (originX, originY). A chunked map keeps only
+    // the chunks around the ball and the camera in walls and circles, and moves the origin
+    // along with them (see ChunkCache.h). Other maps hold all of their obstacles, at origin 0.
+    uint16_t originX;
+    uint16_t originY;
+    uint16_t firstChunk;  // index of the map's first chunk in ObstacleChunks
+    uint8_t chunkColumns; // 0 for a map that isn't chunked
+    uint8_t chunkRows;
+
     Wall walls[MaxNumWalls];
     Circle circles[MaxNumCircles];
-    SandTrap sandTraps[MaxNumSandTraps];
-    Treadmill treadmills[MaxNumTreadmills];
+    Polygon polygons[MaxNumPolygons];
+    Mover movers[MaxNumMovers];
 };
@@ -1,56 +1,145 @@
 #pragma once
 
+#include "Constants.h"
 #include "FX/ArduboyFX.h"
 #include "FX/fxdata.h"
+#include "ForceField.h"
 #include "Map.h"
+#include "Movers.h"
+#include "Terrain.h"
+#include "Vector.h"
+
+// Entry of the course directory in FX data (16 bytes). A course plays the maps listed in
+// CourseHoles from firstHole on, so several courses can share the same maps.
+struct Course
+{
+    static constexpr uint8_t NameLength = 12; // including the terminating NUL
+
+    uint16_t firstHole; // index into CourseHoles
+    uint8_t numHoles;
+    uint8_t totalPar;
+    char name[NameLength];
+};
 
 class MapManager
 {
 public:
-    static const uint8_t NumMaps = 9;
+    static constexpr uint8_t MaxCourseHoles = 9; // scores are kept per hole of the course
+    static constexpr uint8_t MapNameLength = 16; // including the terminating NUL
 
-    static Map LoadMap(uint8_t index)
+    // Courses, maps and names all stay in FX data; only the ones in use are read
+    static uint8_t GetNumCourses()
     {
-        Map map;
+        uint8_t count;
+        FX::readDataBytes(CourseCount, &count, 1);
+        return count;
+    }
 
-        // read Map from FX data
-        FX::seekArrayElement<Map>(Maps, index);
-        FX::readObject(map);
+    static Course LoadCourse(uint8_t courseIdx)
+    {
+        Course course;
+        FX::seekArrayElement<Course>(Courses, courseIdx);
+        FX::readObject(course);
         FX::readEnd();
 
-        map.name = MapNames[index];
+        course.numHoles = min(course.numHoles, MaxCourseHoles);
+        return course;
+    }
 
-        return map;
+    // Index into Maps of a hole of the course
+    static uint8_t GetMapIndex(const Course &course, uint8_t holeIdx)
+    {
+        uint8_t mapIndex;
+        FX::readDataBytes(CourseHoles + course.firstHole + holeIdx, &mapIndex, 1);
+        return mapIndex;
     }
 
-    static uint8_t GetTotalPar()
+    static void ReadMapName(uint8_t index, char *name)
+    {
+        FX::readDataBytes(MapNames + static_cast<uint24_t>(index) * MapNameLength, reinterpret_cast<uint8_t *>(name), MapNameLength);
+    }
+
+    static Map LoadMap(uint8_t index)
     {
-        uint8_t total = 0;
         Map map;
+        uint8_t progress = 0;
+        while (!LoadMapStep(index, map, progress))
+            ;
 
-        for (uint8_t i = 0; i < NumMaps; i++)
-        {
-            // read Map from FX data
-            FX::seekArrayElement<Map>(Maps, i);
-            FX::readObject(map);
-            FX::readEnd();
+        return map;
+    }
 
-            total += map.par;
+    // Loads a map a piece at a time, so the work can be spread over frames: at most
+    // MapPreloadBytesPerFrame bytes of FX data or one polygon per call. Start with
+    // progress = 0 and call again until it returns true. The Map is unusable until then.
+    static bool LoadMapStep(uint8_t index, Map &map, uint8_t &progress)
+    {
+        if (progress < MapChunks)
+        {
+            uint16_t offset = progress * MapPreloadBytesPerFrame;
+            uint8_t count = min(static_cast<uint16_t>(sizeof(Map) - offset), static_cast<uint16_t>(MapPreloadBytesPerFrame));
+            FX::readDataBytes(Maps + static_cast<uint24_t>(index) * sizeof(Map) + offset, reinterpret_cast<uint8_t *>(&map) + offset, count);
+        }
+        else if (progress < MapChunks + Map::MaxNumPolygons)
+        {
+            Polygon &polygon = map.polygons[progress - MapChunks];
+            if (!polygon.IsEmpty())
+                PrecomputePolygon(polygon);
+        }
+        else
+        {
+            ReadMapName(index, _mapName);
+            map.name = _mapName;
+            map.terrain = Terrain::GetGridAddress(index);
+            ForceField::LoadMapField(map, index);
+            for (auto &mover : map.movers)
+                Movers::Validate(mover);
+            return true;
         }
 
-        return total;
+        ++progress;
+        return false;
     }
 
-    static const char *MapNames[NumMaps];
+private:
+    static constexpr uint8_t MapChunks = (sizeof(Map) + MapPreloadBytesPerFrame - 1) / MapPreloadBytesPerFrame;
+
+    static char _mapName[MapNameLength]; // name of the last loaded map
+
+    // Fills in the bounding circle and the outward edge normals of a polygon
+    static void PrecomputePolygon(Polygon &polygon)
+    {
+        float centerX = 0;
+        float centerY = 0;
+        for (uint8_t i = 0; i < polygon.vertexCount; i++)
+        {
+            centerX += polygon.vertices[i].x;
+            centerY += polygon.vertices[i].y;
+        }
+        centerX /= polygon.vertexCount;
+        centerY /= polygon.vertexCount;
+
+        polygon.center = Point8(round(centerX), round(centerY));
+
+        float radius = 0;
+        for (uint8_t i = 0; i < polygon.vertexCount; i++)
+        {
+            Vector toVertex = Vector{polygon.vertices[i].x - centerX, polygon.vertices[i].y - centerY};
+            radius = max(radius, toVertex.Length());
+
+            const Point8 &next = polygon.vertices[(i + 1) % polygon.vertexCount];
+            Vector normal = Vector{next.y - polygon.vertices[i].y, polygon.vertices[i].x - next.x}.Normalize();
+
+            // the centroid is inside a convex polygon, so the outward normal points away from it
+            if (normal.DotProduct(toVertex) < 0)
+                normal = normal * -1;
+
+            polygon.normalX[i] = round(normal.x * 127);
+            polygon.normalY[i] = round(normal.y * 127);
+        }
+
+        polygon.radius = ceil(radius) + 1; // the center was rounded by up to half a pixel on each axis
+    }
 };
 
-const char *MapManager::MapNames[MapManager::NumMaps] = {
-    "Squiggly Lane",
-    "Solar System",
-    "The Diamond",
-    "Treadmill Twist",
-    "Haunted Hallway",
-    "Options",
-    "Plinko",
-    "Ricochet",
-    "Quadrants"};
\ No newline at end of file
+char MapManager::_mapName[MapManager::MapNameLength];
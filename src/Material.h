@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Ball.h"
+#include "FX/ArduboyFX.h"
+#include "FX/fxdata.h"
+#include <Arduboy2.h>
+
+namespace MaterialFlags
+{
+    constexpr uint8_t Sticky = 1 << 0; // ball stops dead on contact
+}
+
+// What Camera::DrawMap draws on a terrain cell
+enum class TerrainSprite : uint8_t
+{
+    None, // cell outline only
+    Sand,
+    TreadmillUp,
+    TreadmillDown,
+    TreadmillLeft,
+    TreadmillRight
+};
+
+// Indices into the FX Materials table, referenced by walls, circles and terrain cells in the map data
+namespace MaterialId
+{
+    constexpr uint8_t Default = 0;
+    constexpr uint8_t Sand = 1;
+    constexpr uint8_t TreadmillUp = 2;
+    constexpr uint8_t TreadmillDown = 3;
+    constexpr uint8_t TreadmillLeft = 4;
+    constexpr uint8_t TreadmillRight = 5;
+    constexpr uint8_t Ice = 6;
+    constexpr uint8_t Rubber = 7;
+    constexpr uint8_t Mud = 8;
+    constexpr uint8_t Glue = 9;
+    constexpr uint8_t Padding = 10;
+}
+
+// One entry of the FX Materials table (6 bytes)
+struct Material
+{
+    uint8_t restitution; // bounce off walls and circles, percent of the incoming normal velocity (at most 100 = perfect)
+    int8_t friction;     // extra friction on a terrain cell, in tenths of the ground's (negative = slippery, at least MinFriction)
+    int8_t pushX;        // velocity added to a ball on a terrain cell every second
+    int8_t pushY;
+    uint8_t flags;       // MaterialFlags
+    TerrainSprite sprite;
+};
+
+class Materials
+{
+    Materials() = delete; // enforce this to be a static class
+
+public:
+    static constexpr uint8_t MaxNumMaterials = 16;
+    static constexpr uint8_t NumMaterials = 11;
+    static constexpr uint8_t MaxRestitution = 100; // more would add energy on every bounce
+    static constexpr int8_t MinFriction = -9;      // keeps a tenth of the ground's friction, so every ball stops
+
+    // Reads the table from FX data, clamps it to values the physics can handle and precomputes
+    // the per-PhysicsStep friction of each material. Call once after FX::begin().
+    static void Load()
+    {
+        FX::readDataObject(MaterialTable, _materials);
+
+        for (uint8_t i = 0; i < NumMaterials; i++)
+        {
+            Material &material = _materials[i];
+            material.restitution = min(material.restitution, MaxRestitution);
+            material.friction = max(material.friction, MinFriction);
+            _decay[i] = material.friction == 0 ? 1 : Ball::FrictionDecay(material.friction / 10.0f);
+        }
+    }
+
+    static const Material &Get(uint8_t index)
+    {
+        return _materials[index];
+    }
+
+    // Velocity multiplier applied each Ball::PhysicsStep while on a terrain cell of this material
+    static float GetDecay(uint8_t index)
+    {
+        return _decay[index];
+    }
+
+private:
+    static_assert(NumMaterials <= MaxNumMaterials, "material indices must fit in 4 bits");
+
+    static Material _materials[NumMaterials];
+    static float _decay[NumMaterials];
+};
+
+Material Materials::_materials[Materials::NumMaterials];
+float Materials::_decay[Materials::NumMaterials];
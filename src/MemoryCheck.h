@@ -0,0 +1,183 @@
+#pragma once
+
+// SRAM budget of the sketch. The budget below is checked at compile time, so a change
+// that grows Game or a static table past it fails the build. Libraries and StackAndHeap
+// are unmeasured placeholders, not a worst case: until they are checked against the link
+// map (avr-size, avr-nm) and a MEMORY_CHECK run, the assert can pass on a sketch that
+// still resets under a heavy screen.
+//
+// Debug aid: when MEMORY_CHECK is defined (see MiniGolf.ino), the size of every class
+// and static table is printed over Serial on boot, one line each:
+//
+//   sizeof <name> <bytes>
+//
+// The free RAM between the heap and the stack is then painted with a marker byte and,
+// every ReportFrames frames, a line is printed:
+//
+//   memory <frame> <stack high-water> <heap high-water> <never touched>
+//
+// Both high-water marks are read from the paint: the longest run of marker bytes left is
+// the gap that neither the stack nor the heap ever reached, the stack is what lies above
+// it and the heap what lies below. This catches the String temporaries of the draw paths,
+// which are freed again long before the end of the frame.
+//
+// Play through the heaviest screens (4-player scorecard, pause menu, endless hole
+// generation) and keep StackAndHeap above the worst stack + heap seen.
+
+#include "Ball.h"
+#include "Camera.h"
+#include "ChunkCache.h"
+#include "ForceField.h"
+#include "FrameTracker.h"
+#include "Game.h"
+#include "Ghost.h"
+#include "HoleGenerator.h"
+#include "Map.h"
+#include "MapManager.h"
+#include "Material.h"
+#include "Terrain.h"
+#include "UIText.h"
+#include <Arduboy2.h>
+
+namespace MemoryBudget
+{
+    constexpr uint16_t Sram = 2560; // ATmega32U4
+
+    // screen buffer, plus the globals of the Arduino core (USB, timers), Arduboy2 and ArduboyFX.
+    // PLACEHOLDER: the 160 bytes are a guess, not read from a link map.
+    constexpr uint16_t Libraries = WIDTH * HEIGHT / 8 + 160;
+
+    // statics of the sketch outside of Game
+    constexpr uint16_t MaterialTables = Materials::NumMaterials * (sizeof(Material) + sizeof(float));
+    constexpr uint16_t TerrainPatches = Terrain::MaxPatches * sizeof(TerrainPatch) + 1;
+    constexpr uint16_t Statics = sizeof(Arduboy2Base) + MaterialTables + TerrainPatches +
+                                 MapManager::MapNameLength + UIText::SlotSize + 2 * sizeof(uint24_t);
+
+    // stack plus the heap (String temporaries of the text renderer).
+    // PLACEHOLDER: a guess, not yet the worst case seen in a MEMORY_CHECK run.
+    constexpr uint16_t StackAndHeap = 384;
+
+    constexpr uint16_t Total = Libraries + sizeof(Game) + Statics + StackAndHeap;
+}
+
+// sizes only mean something on the target: host builds have wider pointers and padding
+#ifdef __AVR__
+static_assert(MemoryBudget::Total <= MemoryBudget::Sram, "SRAM budget exceeded: globals leave too little room for the stack");
+#endif
+
+#ifdef MEMORY_CHECK
+
+extern uint8_t __heap_start; // avr-libc: bottom of the heap
+extern char *__brkval;       // avr-libc: top of the heap, 0 until the first allocation
+
+class MemoryCheck
+{
+    MemoryCheck() = delete; // enforce this to be a static class
+
+    static constexpr uint8_t PaintByte = 0xA5;
+    static constexpr uint8_t StackMargin = 32; // stays clear of the painting function's own frame
+    static constexpr uint8_t ReportFrames = 120;
+
+public:
+    // Call at the end of setup(), with the stack near its shallowest
+    static void Begin()
+    {
+        Serial.begin(9600);
+        while (!Serial)
+            ;
+
+        PrintSizes();
+
+        _paintStart = GetHeapTop();
+        _paintEnd = reinterpret_cast<uint8_t *>(SP) - StackMargin;
+        for (uint8_t *p = _paintStart; p < _paintEnd; p++)
+            *p = PaintByte;
+    }
+
+    // Call once per frame
+    static void Tick()
+    {
+        if (++_frames % ReportFrames == 0)
+            Report();
+    }
+
+private:
+    static uint8_t *_paintStart;
+    static uint8_t *_paintEnd;
+    static uint16_t _frames;
+
+    static uint8_t *GetHeapTop()
+    {
+        return __brkval != nullptr ? reinterpret_cast<uint8_t *>(__brkval) : &__heap_start;
+    }
+
+    static void Report()
+    {
+        // the stack grows down into the painted bytes and the heap grows up into them, both
+        // may leave a few marker bytes of their own untouched (padding, unused buffer space)
+        uint8_t *gap = _paintStart;
+        uint16_t untouched = 0;
+        uint8_t *run = _paintStart;
+        for (uint8_t *p = _paintStart; p < _paintEnd; p++)
+        {
+            if (*p != PaintByte)
+            {
+                run = p + 1;
+                continue;
+            }
+
+            if (p + 1 - run > untouched)
+            {
+                gap = run;
+                untouched = p + 1 - run;
+            }
+        }
+
+        uint16_t stack = RAMEND + 1 - reinterpret_cast<uint16_t>(gap + untouched);
+        uint16_t heap = gap - &__heap_start;
+
+        Serial.print(F("memory "));
+        Serial.print(_frames);
+        Serial.print(' ');
+        Serial.print(stack);
+        Serial.print(' ');
+        Serial.print(heap);
+        Serial.print(' ');
+        Serial.println(untouched);
+    }
+
+    static void PrintSize(const __FlashStringHelper *name, uint16_t bytes)
+    {
+        Serial.print(F("sizeof "));
+        Serial.print(name);
+        Serial.print(' ');
+        Serial.println(bytes);
+    }
+
+    static void PrintSizes()
+    {
+        PrintSize(F("Game"), sizeof(Game));
+        PrintSize(F("Map"), sizeof(Map));
+        PrintSize(F("ChunkCache"), sizeof(ChunkCache));
+        PrintSize(F("Camera"), sizeof(Camera));
+        PrintSize(F("Ball"), sizeof(Ball));
+        PrintSize(F("Terrain"), sizeof(Terrain));
+        PrintSize(F("ForceField"), sizeof(ForceField));
+        PrintSize(F("GhostPlayer"), sizeof(GhostPlayer));
+        PrintSize(F("GhostRecorder"), sizeof(GhostRecorder));
+        PrintSize(F("HoleGenerator"), sizeof(HoleGenerator));
+        PrintSize(F("FrameTracker"), sizeof(FrameTracker));
+        PrintSize(F("Course"), sizeof(Course));
+        PrintSize(F("Materials"), MemoryBudget::MaterialTables);
+        PrintSize(F("TerrainPatches"), MemoryBudget::TerrainPatches);
+        PrintSize(F("Statics"), MemoryBudget::Statics);
+        PrintSize(F("Libraries"), MemoryBudget::Libraries);
+        PrintSize(F("Budget"), MemoryBudget::Total);
+    }
+};
+
+uint8_t *MemoryCheck::_paintStart;
+uint8_t *MemoryCheck::_paintEnd;
+uint16_t MemoryCheck::_frames = 0;
+
+#endif
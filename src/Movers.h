@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Map.h"
+#include <Arduboy2.h>
+
+// Straight edge of a mover at one instant
+struct Segment
+{
+    float x1, y1, x2, y2;
+};
+
+// Area a mover covers, in map pixels. A Rect's 8 bit size can't hold a long blade's sweep.
+struct Bounds
+{
+    int16_t left, top, right, bottom;
+};
+
+// Evaluates the moving obstacles of a map. Every mover follows a fixed cycle, so its
+// position only depends on the global mover clock (counted in Ball::PhysicsSteps).
+class Movers
+{
+    Movers() = delete; // enforce this to be a static class
+
+public:
+    static constexpr uint8_t MaxSegments = 4; // a Block's four edges
+    static constexpr uint8_t MinPeriodShift = 1;  // a cycle of 2 steps
+    static constexpr uint8_t MaxPeriodShift = 16; // a cycle of the whole 16 bit clock
+
+    // Makes a mover from FX data safe to evaluate: one without length or area has edges that
+    // can't be collided with, so it is dropped, and the period is clamped to what GetCycle()
+    // can shift by. Call on every mover of a loaded map.
+    static void Validate(Mover &mover)
+    {
+        bool degenerate;
+        switch (mover.type)
+        {
+            case MoverType::Rotor:
+                degenerate = mover.b.x == 0;
+                break;
+            case MoverType::Slider:
+                degenerate = mover.a.x == mover.b.x && mover.a.y == mover.b.y;
+                break;
+            case MoverType::Block:
+                degenerate = mover.b.x == 0 || mover.b.y == 0;
+                break;
+            default:
+                degenerate = true;
+                break;
+        }
+
+        if (degenerate)
+            mover.type = MoverType::None;
+        mover.periodShift = constrain(mover.periodShift, MinPeriodShift, MaxPeriodShift);
+    }
+
+    // Writes the mover's edges at the given clock tick and returns how many there are
+    static uint8_t GetSegments(const Mover &mover, uint16_t tick, Segment *segments)
+    {
+        uint16_t cycle = GetCycle(mover, tick);
+
+        switch (mover.type)
+        {
+            case MoverType::Rotor:
+            {
+                float angle = cycle * (TWO_PI / 65536);
+                float dx = cos(angle) * mover.b.x;
+                float dy = -sin(angle) * mover.b.x;
+                segments[0] = {mover.a.x - dx, mover.a.y - dy, mover.a.x + dx, mover.a.y + dy};
+                return 1;
+            }
+            case MoverType::Slider:
+            {
+                float stroke = GetStroke(cycle);
+                float x = mover.travelX * stroke;
+                float y = mover.travelY * stroke;
+                segments[0] = {mover.a.x + x, mover.a.y + y, mover.b.x + x, mover.b.y + y};
+                return 1;
+            }
+            case MoverType::Block:
+            {
+                float stroke = GetStroke(cycle);
+                float left = mover.a.x + mover.travelX * stroke;
+                float top = mover.a.y + mover.travelY * stroke;
+                float right = left + mover.b.x;
+                float bottom = top + mover.b.y;
+                segments[0] = {left, top, right, top};
+                segments[1] = {right, top, right, bottom};
+                segments[2] = {right, bottom, left, bottom};
+                segments[3] = {left, bottom, left, top};
+                return 4;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    // Area the mover covers over its whole cycle
+    static Bounds GetBounds(const Mover &mover)
+    {
+        int16_t left = mover.a.x;
+        int16_t top = mover.a.y;
+        int16_t right = left + mover.b.x;
+        int16_t bottom = top + mover.b.y;
+
+        if (mover.type == MoverType::Rotor)
+            return {static_cast<int16_t>(left - mover.b.x), static_cast<int16_t>(top - mover.b.x), right, static_cast<int16_t>(top + mover.b.x)};
+
+        if (mover.type == MoverType::Slider)
+        {
+            left = min(mover.a.x, mover.b.x);
+            top = min(mover.a.y, mover.b.y);
+            right = max(mover.a.x, mover.b.x);
+            bottom = max(mover.a.y, mover.b.y);
+        }
+
+        left += min(mover.travelX, 0);
+        top += min(mover.travelY, 0);
+        right += max(mover.travelX, 0);
+        bottom += max(mover.travelY, 0);
+
+        return {left, top, right, bottom};
+    }
+
+private:
+    // Position in the cycle, a full cycle being 65536. The shift is done unsigned, as it
+    // wraps around. periodShift is within MinPeriodShift and MaxPeriodShift (see Validate).
+    static uint16_t GetCycle(const Mover &mover, uint16_t tick)
+    {
+        return static_cast<uint16_t>(static_cast<unsigned int>(tick) << (16 - mover.periodShift)) +
+               static_cast<uint16_t>(static_cast<unsigned int>(mover.phase) << 8);
+    }
+
+    // 0 at the start of the cycle, 1 halfway through and back to 0 at the end
+    static float GetStroke(uint16_t cycle)
+    {
+        return (cycle < 0x8000 ? cycle : 0x10000 - cycle) * (1.0f / 0x8000);
+    }
+};
@@ -0,0 +1,225 @@
+#pragma once
+
+// Debug aid for renderer changes. When RENDER_CHECK is defined (see MiniGolf.ino), the
+// game renders a fixed set of frames on boot: every map of every course (chunked ones
+// with their chunks streamed in) and a few endless mode holes at a grid of camera
+// positions, and every UI screen. For each frame it prints a checksum of the screen
+// buffer and the render time over Serial, one line per frame:
+//
+//   <render path> <map> <x> <y> <checksum> <microseconds>
+//
+// <map> is the map index of a hole, FirstEndlessId + n for the endless holes and the
+// course index on the course screens.
+//
+// Capture the output of a known-good build and record it as the golden log with
+// tools/compare_render_check.py --record, then run the script on the output of later
+// builds. It fails on any changed checksum, which means a render path changed its pixels.
+// The golden log has to come from the device: the renderers draw through Arduboy2 and
+// the FX chip, which have no host implementation in this tree.
+
+#ifdef RENDER_CHECK
+
+#include "Ball.h"
+#include "Camera.h"
+#include "ChunkCache.h"
+#include "HoleGenerator.h"
+#include "Map.h"
+#include "MapManager.h"
+#include <Arduboy2.h>
+
+class RenderCheck
+{
+    RenderCheck() = delete; // enforce this to be a static class
+
+    static constexpr uint8_t CameraGridStep = 32;
+    static constexpr uint8_t NumEndlessSeeds = 3;
+    static constexpr uint8_t FirstEndlessId = 128; // past the FX maps
+
+public:
+    static void Run(Arduboy2Base &arduboy)
+    {
+        Serial.begin(9600);
+        while (!Serial)
+            ;
+
+        Camera camera(arduboy);
+        Map map;
+
+        // every map of every course, once, including the chunked ones
+        uint32_t checkedMaps = 0;
+        uint8_t numCourses = MapManager::GetNumCourses();
+        for (uint8_t c = 0; c < numCourses; c++)
+        {
+            Course course = MapManager::LoadCourse(c);
+            for (uint8_t i = 0; i < course.numHoles; i++)
+            {
+                uint8_t mapIndex = MapManager::GetMapIndex(course, i);
+                uint32_t bit = mapIndex < 32 ? 1UL << mapIndex : 0;
+                if (checkedMaps & bit)
+                    continue;
+
+                checkedMaps |= bit;
+                map = MapManager::LoadMap(mapIndex);
+                CheckHole(arduboy, camera, map, mapIndex, mapIndex, i + 1);
+            }
+        }
+
+        // endless mode holes, from fixed seeds
+        HoleGenerator generator;
+        for (uint8_t i = 0; i < NumEndlessSeeds; i++)
+        {
+            generator.Begin(i + 1);
+            while (!generator.Step(map))
+                ;
+
+            CheckHole(arduboy, camera, map, FirstEndlessId + i, NoPrerenderedViews, i + 1);
+        }
+
+        camera.Reset(0, 0, WIDTH, HEIGHT);
+
+        for (uint8_t c = 0; c < numCourses; c++)
+        {
+            Course course = MapManager::LoadCourse(c);
+
+            for (uint8_t i = 0; i < StartScreenNumOptions; i++)
+            {
+                unsigned long start = BeginFrame(arduboy);
+                camera.DrawStartScreen(i, course.name, MaxPlayers);
+                EndFrame(F("start-screen"), c, i, 0, start);
+            }
+
+            for (uint8_t i = 0; i < course.numHoles; i++)
+            {
+                unsigned long start = BeginFrame(arduboy);
+                camera.DrawHoleSelection(course, i);
+                EndFrame(F("hole-selection"), c, i, 0, start);
+            }
+
+            unsigned long start = BeginFrame(arduboy);
+            camera.DrawGameSummary(course.totalPar, course.totalPar);
+            EndFrame(F("game-summary"), c, 0, 0, start);
+        }
+
+        for (uint8_t i = 0; i < InstructionsSpriteFrames; i++)
+        {
+            unsigned long start = BeginFrame(arduboy);
+            camera.DrawInstructions(i);
+            EndFrame(F("instructions"), 0, i, 0, start);
+            camera.DiscardPrefetchedBackground();
+        }
+
+        unsigned long start = BeginFrame(arduboy);
+        camera.DrawMapExplorerIndicator();
+        camera.DrawFastForwardIndicator(2);
+        EndFrame(F("indicators"), 0, 0, 0, start);
+
+        Serial.println(F("done"));
+    }
+
+private:
+    static constexpr uint8_t NoPrerenderedViews = UINT8_MAX;
+
+    // Renders one hole at a grid of camera positions, then its panels. id is the <map> of
+    // its lines, viewsIndex the frame of its minimap and overviews, or NoPrerenderedViews.
+    static void CheckHole(Arduboy2Base &arduboy, Camera &camera, Map &map, uint8_t id, uint8_t viewsIndex, uint8_t holeNum)
+    {
+        ChunkCache chunks;
+        chunks.Reset();
+        camera.Reset(0, 0, map.width, map.height);
+        Ball ball(map.start.x, map.start.y);
+
+        for (uint16_t y = 0; y <= map.height; y += CameraGridStep)
+        {
+            for (uint16_t x = 0; x <= map.width; x += CameraGridStep)
+            {
+                camera.FocusOn(x, y);
+                chunks.Update(map, camera.GetX() + WIDTH / 2, camera.GetY() + HEIGHT / 2);
+
+                unsigned long start = BeginFrame(arduboy);
+                camera.DrawMap(map);
+                EndFrame(F("map"), id, x, y, start);
+
+                start = BeginFrame(arduboy);
+                camera.DrawHole(map.end.x, map.end.y, true);
+                camera.DrawBall(ball);
+                camera.DrawAimHud(ball);
+                EndFrame(F("hole+ball+aim"), id, x, y, start);
+            }
+        }
+
+        camera.FocusOn(ball.X, ball.Y);
+        chunks.Update(map, camera.GetX() + WIDTH / 2, camera.GetY() + HEIGHT / 2);
+
+        unsigned long start;
+        if (viewsIndex != NoPrerenderedViews)
+        {
+            start = BeginFrame(arduboy);
+            camera.PlaceMinimap(ball);
+            camera.DrawMap(map, 0, true);
+            camera.DrawMinimap(viewsIndex, map, ball);
+            EndFrame(F("map+minimap"), id, 0, 0, start);
+
+            for (uint8_t zoomShift = 1; zoomShift <= MaxOverviewShift; zoomShift++)
+            {
+                start = BeginFrame(arduboy);
+                camera.DrawOverview(viewsIndex, zoomShift, map, ball);
+                EndFrame(F("overview"), id, zoomShift, 0, start);
+            }
+        }
+
+        start = BeginFrame(arduboy);
+        camera.DrawMapSummary(holeNum, map);
+        EndFrame(F("map-summary"), id, 0, 0, start);
+
+        start = BeginFrame(arduboy);
+        camera.DrawMapComplete(holeNum, map.par, map.par, 0);
+        EndFrame(F("map-complete"), id, 0, 0, start);
+
+        start = BeginFrame(arduboy);
+        camera.DrawMapCompleteNoTotal(holeNum, map, map.par);
+        EndFrame(F("map-complete-no-total"), id, 0, 0, start);
+
+        start = BeginFrame(arduboy);
+        camera.DrawPauseMenu(holeNum, map, map.par, 0);
+        EndFrame(F("pause-menu"), id, 0, 0, start);
+        camera.DiscardPrefetchedBackground();
+    }
+
+    static unsigned long BeginFrame(Arduboy2Base &arduboy)
+    {
+        arduboy.clear();
+        return micros();
+    }
+
+    static void EndFrame(const __FlashStringHelper *path, uint8_t mapIdx, uint16_t x, uint16_t y, unsigned long start)
+    {
+        unsigned long elapsed = micros() - start;
+
+        Serial.print(path);
+        Serial.print(' ');
+        Serial.print(mapIdx);
+        Serial.print(' ');
+        Serial.print(x);
+        Serial.print(' ');
+        Serial.print(y);
+        Serial.print(' ');
+        Serial.print(Checksum(Arduboy2Base::sBuffer, WIDTH * HEIGHT / 8), HEX);
+        Serial.print(' ');
+        Serial.println(elapsed);
+    }
+
+    // CRC-16/CCITT of the screen buffer
+    static uint16_t Checksum(const uint8_t *data, uint16_t length)
+    {
+        uint16_t crc = 0xFFFF;
+        for (uint16_t i = 0; i < length; i++)
+        {
+            crc ^= static_cast<uint16_t>(data[i]) << 8;
+            for (uint8_t bit = 0; bit < 8; bit++)
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+        return crc;
+    }
+};
+
+#endif
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "FX/ArduboyFX.h"
+#include "FX/fxdata.h"
+#include "Map.h"
+#include "Material.h"
+#include <Arduboy2.h>
+
+// Floor of a map, stored in FX data as a grid of 8x8 pixel cells holding the 4 bit index
+// of the cell's material. Two cells per byte, the left cell in the high nibble.
+//
+// An instance caches the cell the ball was last looked up in, so the ball's floor costs
+// one FX read whenever it crosses into another cell instead of a test against every region.
+//
+// Generated holes have no grid in FX data. Their floor is a few rectangular patches kept in
+// RAM, which ReadRow() turns into the same packed rows.
+struct TerrainPatch
+{
+    uint8_t column, row; // top left cell
+    uint8_t columns, rows;
+    uint8_t material;
+};
+
+class Terrain
+{
+public:
+    static constexpr uint8_t CellShift = 3;
+    static constexpr uint8_t CellSize = 1 << CellShift;
+    static constexpr uint8_t GridColumns = 32; // 32 * CellSize covers the largest possible map (255 pixels)
+    static constexpr uint8_t GridRows = 32;
+    static constexpr uint8_t RowBytes = GridColumns / 2;
+    static constexpr uint16_t GridBytes = RowBytes * GridRows;
+    static constexpr uint24_t PatchGrid = 0xFFFFFF; // Map::terrain of a generated hole
+    static constexpr uint8_t MaxPatches = 4;
+
+    static uint24_t GetGridAddress(uint8_t mapIndex)
+    {
+        return TerrainGrids + static_cast<uint24_t>(mapIndex) * GridBytes;
+    }
+
+    // Reads `count` bytes (two cells each) of a row, starting at cell column 2 * firstByte
+    static void ReadRow(uint24_t grid, uint8_t row, uint8_t firstByte, uint8_t *cells, uint8_t count)
+    {
+        if (grid == PatchGrid)
+            ReadPatchRow(row, firstByte, cells, count);
+        else
+            FX::readDataBytes(grid + row * RowBytes + firstByte, cells, count);
+    }
+
+    static void ClearPatches()
+    {
+        _numPatches = 0;
+    }
+
+    static bool AddPatch(const TerrainPatch &patch)
+    {
+        if (_numPatches == MaxPatches)
+            return false;
+
+        _patches[_numPatches++] = patch;
+        return true;
+    }
+
+    // Extracts the material of a cell from a row read with ReadRow()
+    static uint8_t GetCell(const uint8_t *cells, uint8_t column)
+    {
+        uint8_t pair = cells[column / 2];
+        return column % 2 == 0 ? pair >> 4 : pair & 0x0F;
+    }
+
+    // Material index of the floor under the given map position
+    uint8_t GetMaterial(const Map &map, float x, float y)
+    {
+        if (x < 0 || y < 0 || x >= GridColumns * CellSize || y >= GridRows * CellSize)
+            return MaterialId::Default;
+
+        uint8_t column = static_cast<uint8_t>(x) >> CellShift;
+        uint8_t row = static_cast<uint8_t>(y) >> CellShift;
+        uint16_t cell = row * GridColumns + column;
+
+        if (cell != _cell)
+        {
+            uint8_t pair;
+            ReadRow(map.terrain, row, column / 2, &pair, 1);
+            _cell = cell;
+            _material = GetCell(&pair, column % 2);
+        }
+
+        return _material;
+    }
+
+private:
+    static constexpr uint16_t NoCell = UINT16_MAX;
+
+    static TerrainPatch _patches[MaxPatches];
+    static uint8_t _numPatches;
+
+    uint16_t _cell = NoCell;
+    uint8_t _material = MaterialId::Default;
+
+    static void ReadPatchRow(uint8_t row, uint8_t firstByte, uint8_t *cells, uint8_t count)
+    {
+        memset(cells, 0, count);
+
+        uint8_t firstColumn = firstByte * 2;
+        uint8_t endColumn = firstColumn + count * 2;
+
+        for (uint8_t i = 0; i < _numPatches; i++)
+        {
+            const TerrainPatch &patch = _patches[i];
+            if (row < patch.row || row >= patch.row + patch.rows)
+                continue;
+
+            uint8_t start = max(patch.column, firstColumn);
+            uint8_t end = min(patch.column + patch.columns, endColumn);
+            for (uint8_t column = start; column < end; column++)
+            {
+                uint8_t &pair = cells[(column - firstColumn) / 2];
+                if (column % 2 == 0)
+                    pair = (pair & 0x0F) | (patch.material << 4);
+                else
+                    pair = (pair & 0xF0) | patch.material;
+            }
+        }
+    }
+};
+
+TerrainPatch Terrain::_patches[Terrain::MaxPatches];
+uint8_t Terrain::_numPatches = 0;
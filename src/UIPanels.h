@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduboy2.h>
+
+// Screen positions of the pre-baked UI panels (src/Assets/*Panel_*.png) and of the
+// slots where the runtime values are printed over them. These are printed by
+// src/Assets/generate_panels.py and must be kept in sync with it.
+// Every panel has two frames, one per phase of the flickering dotted border.
+namespace UIPanels
+{
+    // the box is sized for map names of up to 15 characters
+    namespace MapSummary
+    {
+        constexpr uint8_t X = 18;
+        constexpr uint8_t Y = 18;
+        constexpr uint8_t TextY = 20; // first of the three centered lines
+    }
+
+    // hole number slots leave room for a single digit
+    namespace MapComplete
+    {
+        constexpr uint8_t X = 13;
+        constexpr uint8_t Y = 6;
+        constexpr uint8_t HoleSlotX = 50;
+        constexpr uint8_t HoleSlotY = 8;
+        constexpr uint8_t ParSlotX = 85;
+        constexpr uint8_t ParSlotY = 16;
+        constexpr uint8_t StrokesSlotX = 85;
+        constexpr uint8_t StrokesSlotY = 24;
+        constexpr uint8_t TotalSlotX = 90;
+        constexpr uint8_t TotalSlotY = 40;
+    }
+
+    namespace MapCompleteNoTotal
+    {
+        constexpr uint8_t X = 13;
+        constexpr uint8_t Y = 8;
+        constexpr uint8_t HoleSlotX = 50;
+        constexpr uint8_t HoleSlotY = 10;
+        constexpr uint8_t ParSlotX = 85;
+        constexpr uint8_t ParSlotY = 18;
+        constexpr uint8_t StrokesSlotX = 85;
+        constexpr uint8_t StrokesSlotY = 26;
+    }
+
+    namespace GameSummary
+    {
+        constexpr uint8_t X = 13;
+        constexpr uint8_t Y = 5;
+        constexpr uint8_t ParSlotX = 82;
+        constexpr uint8_t ParSlotY = 31;
+        constexpr uint8_t StrokesSlotX = 82;
+        constexpr uint8_t StrokesSlotY = 39;
+        constexpr uint8_t TotalSlotX = 82;
+        constexpr uint8_t TotalSlotY = 47;
+    }
+
+    // full screen, drawn as a prefetched background
+    namespace PauseMenu
+    {
+        constexpr uint8_t HoleSlotX = 104;
+        constexpr uint8_t HoleSlotY = 0;
+        constexpr uint8_t ParSlotX = 114;
+        constexpr uint8_t ParSlotY = 8;
+        constexpr uint8_t StrokesSlotX = 114;
+        constexpr uint8_t StrokesSlotY = 16;
+        constexpr uint8_t OptionsX = 0;
+        constexpr uint8_t OptionsY = 48;
+    }
+}
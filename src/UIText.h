@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Constants.h"
+#include "FX/ArduboyFX.h"
+#include "FX/fxdata.h"
+#include <Arduboy2.h>
+
+// Text of the UI, kept in FX data (UIStringTable) instead of RAM or program flash. Every
+// string has a slot of SlotSize bytes, NUL padded, at the position given by its id below.
+class UIText
+{
+    UIText() = delete; // enforce this to be a static class
+
+public:
+    static constexpr uint8_t SlotSize = 16; // including the terminating NUL
+
+    static constexpr uint8_t StartMenuOptions = 0; // StartScreenNumOptions consecutive strings
+    static constexpr uint8_t ViewMap = 6;
+    static constexpr uint8_t Generating = 7;
+    static constexpr uint8_t Final = 8;
+    static constexpr uint8_t Hole = 9;
+    static constexpr uint8_t Par = 10;
+    static constexpr uint8_t Seed = 11;
+
+    // Reads a string into the shared line buffer. The text is only valid until the next
+    // call, so copy it (e.g. into a String) before reading another one.
+    static const char *Read(uint8_t id)
+    {
+        FX::readDataBytes(UIStringTable + static_cast<uint16_t>(id) * SlotSize, reinterpret_cast<uint8_t *>(_line), SlotSize);
+        return _line;
+    }
+
+private:
+    static char _line[SlotSize];
+};
+
+static_assert(UIText::ViewMap == UIText::StartMenuOptions + StartScreenNumOptions, "UIStringTable has one start menu entry per option");
+
+char UIText::_line[UIText::SlotSize];
@@ -13,7 +13,12 @@ struct Vector
 
     float Length() const
     {
-        return sqrt(x * x + y * y);
+        return sqrt(LengthSquared());
+    }
+
+    float LengthSquared() const
+    {
+        return x * x + y * y;
     }
 
     Vector Normalize() const
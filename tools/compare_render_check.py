@@ -0,0 +1,92 @@
+# Compares the Serial output of a RENDER_CHECK build (see src/RenderCheck.h) against the
+# golden log of a known-good build, and fails if any rendered frame changed.
+#
+#   python3 compare_render_check.py capture.txt            # diff against render_check_golden.txt
+#   python3 compare_render_check.py capture.txt --record   # make capture.txt the new golden log
+#
+# Capture the output with any serial monitor at 9600 baud, from boot until the "done"
+# line, e.g. `cat /dev/ttyACM0 > capture.txt`. Each line is
+#
+#   <render path> <map> <x> <y> <checksum> <microseconds>
+#
+# Frames are matched on their path, map and position. Checksums must match exactly; render
+# times only produce a warning when a path got slower by more than --slower percent.
+
+import argparse
+import os
+import sys
+
+GOLDEN = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'render_check_golden.txt')
+
+
+def load(path):
+    frames = {}
+    done = False
+    for line in open(path, errors='replace'):
+        fields = line.split()
+        if fields == ['done']:
+            done = True
+            continue
+        if len(fields) != 6:
+            continue  # Serial noise, or the sizes printed by MEMORY_CHECK
+        key = tuple(fields[:4])
+        frames[key] = (fields[4].upper(), int(fields[5]))
+    return frames, done
+
+
+def total_times(frames):
+    times = {}
+    for (path, *_), (_, micros) in frames.items():
+        times[path] = times.get(path, 0) + micros
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('capture')
+    parser.add_argument('--golden', default=GOLDEN)
+    parser.add_argument('--record', action='store_true', help='replace the golden log with the capture')
+    parser.add_argument('--slower', type=int, default=20, help='render time increase (percent) to warn about')
+    args = parser.parse_args()
+
+    captured, done = load(args.capture)
+    if not done:
+        sys.exit('%s: no "done" line, the capture is incomplete' % args.capture)
+
+    if args.record:
+        with open(args.golden, 'w') as f:
+            for key, (checksum, micros) in captured.items():
+                f.write('%s %s %d\n' % (' '.join(key), checksum, micros))
+            f.write('done\n')
+        print('recorded %d frames into %s' % (len(captured), args.golden))
+        return
+
+    if not os.path.exists(args.golden):
+        sys.exit('%s not found: record it from a known-good build with --record' % args.golden)
+    golden, _ = load(args.golden)
+
+    failures = 0
+    for key, (checksum, _) in golden.items():
+        if key not in captured:
+            print('missing  %s' % ' '.join(key))
+            failures += 1
+        elif captured[key][0] != checksum:
+            print('changed  %s  %s -> %s' % (' '.join(key), checksum, captured[key][0]))
+            failures += 1
+    for key in captured:
+        if key not in golden:
+            print('new      %s' % ' '.join(key))
+            failures += 1
+
+    golden_times = total_times(golden)
+    for path, micros in sorted(total_times(captured).items()):
+        before = golden_times.get(path)
+        if before and micros * 100 > before * (100 + args.slower):
+            print('slower   %s  %d -> %d us' % (path, before, micros))
+
+    print('%d differences over %d golden frames' % (failures, len(golden)))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()
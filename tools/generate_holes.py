@@ -0,0 +1,320 @@
+# Runs the endless mode hole generator (src/HoleGenerator.h) over a range of seeds on the
+# host and reports how often a seed gives an unreachable hole and has to be reseeded, and
+# how many Step() calls (frames) a hole takes.
+#
+#   python3 generate_holes.py                   # seeds 1 to 1000
+#   python3 generate_holes.py --first 1 --count 65535 --verbose
+#
+# This is a port of HoleGenerator, keep the two in sync. The arithmetic follows the target:
+# uint8_t truncation where the generator stores into bytes, and 16 bit int wrap-around
+# where it multiplies int16_t values.
+
+import argparse
+
+MIN_GAP = 24
+MAX_BAFFLES = 4
+MAX_PEGS = 6
+PEG_ATTEMPTS = 4
+CLEAR_RADIUS = 16
+
+CELL_SHIFT = 4
+CELL_SIZE = 1 << CELL_SHIFT
+GRID_SIZE = 16
+
+TERRAIN_CELL_SHIFT = 3
+MAX_PATCHES = 4
+BALL_RADIUS = 2
+
+
+def u8(value):
+    return value & 0xFF
+
+
+def u16(value):
+    return value & 0xFFFF
+
+
+def s16(value):
+    value &= 0xFFFF
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def orientation(ax, ay, bx, by, px, py):
+    cross = (bx - ax) * (py - ay) - (by - ay) * (px - ax)
+    return (cross > 0) - (cross < 0)
+
+
+def segments_intersect(ax, ay, bx, by, cx, cy, dx, dy):
+    d1 = orientation(cx, cy, dx, dy, ax, ay)
+    d2 = orientation(cx, cy, dx, dy, bx, by)
+    d3 = orientation(ax, ay, bx, by, cx, cy)
+    d4 = orientation(ax, ay, bx, by, dx, dy)
+
+    if d1 * d2 > 0 or d3 * d4 > 0:
+        return False
+
+    if d1 == 0 and d2 == 0:
+        return (max(ax, bx) >= min(cx, dx) and max(cx, dx) >= min(ax, bx) and
+                max(ay, by) >= min(cy, dy) and max(cy, dy) >= min(ay, by))
+
+    return True
+
+
+def is_near(x, y, point_x, point_y, distance):
+    dx = s16(x - point_x)
+    dy = s16(y - point_y)
+    return s16(dx * dx + dy * dy) < distance * distance
+
+
+def is_patch_clear(patch, point):
+    column, row, columns, rows = patch
+    left = (column << TERRAIN_CELL_SHIFT) - CLEAR_RADIUS
+    top = (row << TERRAIN_CELL_SHIFT) - CLEAR_RADIUS
+    right = ((column + columns) << TERRAIN_CELL_SHIFT) + CLEAR_RADIUS
+    bottom = ((row + rows) << TERRAIN_CELL_SHIFT) + CLEAR_RADIUS
+    x, y = point
+    return x < left or x >= right or y < top or y >= bottom
+
+
+def get_cell(point):
+    return u8((point[1] >> CELL_SHIFT) * GRID_SIZE + (point[0] >> CELL_SHIFT))
+
+
+class Hole:
+    def __init__(self):
+        self.width = 0
+        self.height = 0
+        self.start = (0, 0)
+        self.end = (0, 0)
+        self.par = 0
+        self.walls = []    # (x1, y1, x2, y2)
+        self.circles = []  # (x, y, radius)
+        self.patches = []  # (column, row, columns, rows)
+
+
+class HoleGenerator:
+    def begin(self, seed):
+        self.seed = u16(seed)
+        self.stage = 'layout'
+
+    # Returns True once the hole is complete
+    def step(self):
+        if self.stage == 'layout':
+            self.generate_layout()
+            self.stage = 'pegs'
+        elif self.stage == 'pegs':
+            if not self.generate_peg():
+                self.stage = 'patches'
+        elif self.stage == 'patches':
+            if not self.generate_patch():
+                self.begin_validation()
+        elif self.stage == 'validate':
+            self.validate()
+        return self.stage == 'done'
+
+    def random(self):
+        r = self.state
+        r = u16(r ^ (r << 7))
+        r = u16(r ^ (r >> 9))
+        r = u16(r ^ (r << 8))
+        self.state = r
+        return r
+
+    def random_range(self, low, high):
+        low, high = u8(low), u8(high)
+        return u8(low + self.random() % (high - low + 1))
+
+    def generate_layout(self):
+        self.state = 1 if self.seed == 0 else self.seed
+
+        hole = self.hole = Hole()
+        hole.width = 32 * self.random_range(4, 7)
+        hole.height = 32 * self.random_range(2, 4)
+
+        right = u8(hole.width - 1)
+        bottom = u8(hole.height - 1)
+        hole.walls = [(0, 0, right, 0), (right, 0, right, bottom), (right, bottom, 0, bottom), (0, bottom, 0, 0)]
+
+        self.num_baffles = self.random_range(0, min(MAX_BAFFLES, hole.width // 48))
+        from_top = self.random() & 1
+        self.baffle_x = []
+        for i in range(self.num_baffles):
+            x = u8(hole.width * (i + 1) // (self.num_baffles + 1)) & ~(CELL_SIZE - 1) & 0xFF
+            gap = self.random_range(MIN_GAP, MIN_GAP + 8)
+            self.random_range(0, 3)  # material
+            if from_top:
+                hole.walls.append((x, 0, x, u8(bottom - gap)))
+            else:
+                hole.walls.append((x, gap, x, bottom))
+            self.baffle_x.append(x)
+            from_top = not from_top
+
+        hole.start = (12, hole.height // 2)
+        hole.end = (hole.width - 12, self.random_range(12, hole.height - 12))
+
+        self.pegs_left = self.random_range(0, MAX_PEGS)
+        self.patches_left = self.random_range(0, MAX_PATCHES)
+        hole.par = 2 + (self.num_baffles + 1) // 2 + (self.pegs_left > MAX_PEGS // 2)
+
+    def generate_peg(self):
+        if self.pegs_left == 0:
+            return False
+
+        self.pegs_left -= 1
+        hole = self.hole
+        for _ in range(PEG_ATTEMPTS):
+            radius = self.random_range(3, 5)
+            x = self.random_range(radius + 6, hole.width - radius - 7)
+            y = self.random_range(radius + 6, hole.height - radius - 7)
+
+            if self.is_peg_clear(x, y, radius):
+                hole.circles.append((x, y, radius))
+                self.random_range(0, 2)  # material
+                return True
+
+        return True
+
+    def is_peg_clear(self, x, y, radius):
+        hole = self.hole
+        if (is_near(x, y, hole.start[0], hole.start[1], CLEAR_RADIUS + radius) or
+                is_near(x, y, hole.end[0], hole.end[1], CLEAR_RADIUS + radius)):
+            return False
+
+        for baffle_x in self.baffle_x:
+            if abs(x - baffle_x) < radius + 10:
+                return False
+
+        for cx, cy, cradius in hole.circles:
+            if is_near(x, y, cx, cy, cradius + radius + 10):
+                return False
+
+        return True
+
+    def generate_patch(self):
+        if self.patches_left == 0:
+            return False
+
+        self.patches_left -= 1
+
+        kind = self.random_range(0, 3)
+        if kind <= 1:  # sand
+            columns = self.random_range(2, 4)
+            rows = self.random_range(2, 3)
+        elif kind == 2:  # horizontal belt
+            columns = self.random_range(4, 6)
+            rows = 1
+            self.random()  # direction
+        else:  # vertical belt
+            columns = 1
+            rows = self.random_range(3, 5)
+            self.random()  # direction
+
+        hole = self.hole
+        column = self.random_range(1, (hole.width >> TERRAIN_CELL_SHIFT) - columns - 1)
+        row = self.random_range(1, (hole.height >> TERRAIN_CELL_SHIFT) - rows - 1)
+        patch = (column, row, columns, rows)
+
+        if is_patch_clear(patch, hole.start) and is_patch_clear(patch, hole.end) and len(hole.patches) < MAX_PATCHES:
+            hole.patches.append(patch)
+        return True
+
+    def begin_validation(self):
+        hole = self.hole
+        self.columns = hole.width >> CELL_SHIFT
+        self.rows = hole.height >> CELL_SHIFT
+        self.reached = set()
+        self.expanded = set()
+
+        start_cell = get_cell(hole.start)
+        self.reached.add(start_cell)
+        self.cursor = start_cell
+        self.idle_cells = 0
+        self.stage = 'validate'
+
+    def validate(self):
+        hole = self.hole
+        if get_cell(hole.end) in self.reached:
+            self.stage = 'done'
+            return
+
+        while self.cursor not in self.reached or self.cursor in self.expanded:
+            self.cursor = u8(self.cursor + 1)
+            self.idle_cells = u8(self.idle_cells + 1)
+            if self.idle_cells == 0:
+                self.begin(self.seed + 1)
+                return
+
+        self.idle_cells = 0
+        self.expanded.add(self.cursor)
+
+        column = self.cursor % GRID_SIZE
+        row = self.cursor // GRID_SIZE
+        if column > 0:
+            self.try_reach(self.cursor, self.cursor - 1)
+        if column < self.columns - 1:
+            self.try_reach(self.cursor, self.cursor + 1)
+        if row > 0:
+            self.try_reach(self.cursor, self.cursor - GRID_SIZE)
+        if row < self.rows - 1:
+            self.try_reach(self.cursor, self.cursor + GRID_SIZE)
+
+    def try_reach(self, start, to):
+        if to not in self.reached and not self.is_path_blocked(start, to):
+            self.reached.add(to)
+
+    def is_path_blocked(self, start, to):
+        x1 = (start % GRID_SIZE) * CELL_SIZE + CELL_SIZE // 2
+        y1 = (start // GRID_SIZE) * CELL_SIZE + CELL_SIZE // 2
+        x2 = (to % GRID_SIZE) * CELL_SIZE + CELL_SIZE // 2
+        y2 = (to // GRID_SIZE) * CELL_SIZE + CELL_SIZE // 2
+
+        for wall in self.hole.walls:
+            if segments_intersect(x1, y1, x2, y2, *wall):
+                return True
+
+        for cx, cy, radius in self.hole.circles:
+            dx = min(max(cx, min(x1, x2)), max(x1, x2)) - cx
+            dy = min(max(cy, min(y1, y2)), max(y1, y2)) - cy
+            reach = radius + BALL_RADIUS
+            if s16(dx * dx + dy * dy) < reach * reach:
+                return True
+
+        return False
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--first', type=int, default=1, help='first seed')
+    parser.add_argument('--count', type=int, default=1000, help='number of seeds')
+    parser.add_argument('--verbose', action='store_true', help='print every seed that was reseeded')
+    args = parser.parse_args()
+
+    generator = HoleGenerator()
+    reseeded = 0
+    total_reseeds = 0
+    max_reseeds = 0
+    total_steps = 0
+    max_steps = 0
+    for seed in range(args.first, args.first + args.count):
+        generator.begin(seed)
+        steps = 1
+        while not generator.step():
+            steps += 1
+
+        reseeds = u16(generator.seed - seed)
+        if reseeds:
+            reseeded += 1
+            if args.verbose:
+                print('seed %d -> %d' % (seed, generator.seed))
+        total_reseeds += reseeds
+        max_reseeds = max(max_reseeds, reseeds)
+        total_steps += steps
+        max_steps = max(max_steps, steps)
+
+    print('%d seeds, %d reseeded (%.3f%%), %d reseeds in total, at most %d for one hole' %
+          (args.count, reseeded, 100.0 * reseeded / args.count, total_reseeds, max_reseeds))
+    print('Step() calls per hole: %.1f on average, at most %d' % (total_steps / args.count, max_steps))
+
+
+if __name__ == '__main__':
+    main()